@@ -0,0 +1,51 @@
+#ifndef _BEHAVIOUR_BATCH_EVALUATOR_HPP
+#define _BEHAVIOUR_BATCH_EVALUATOR_HPP
+
+#include "BehaviorProgram.hpp"
+
+namespace Behavior {
+
+/*
+    The BatchEvaluator executes N independent instances (lanes) of the same Program at once.
+    Values are stored lane-wise (slot * lanes + lane), so every node and merge processes all lanes in one go.
+    Double buffered programs (see Feedback) alternate between two value buffers without copying.
+*/
+class BatchEvaluator
+{
+    public:
+        BatchEvaluator(const Program& program, const std::size_t lanes);
+        ~BatchEvaluator();
+
+        // Sets all node outputs (of both buffers), merge results and inputs of all lanes back to zero
+        void reset();
+
+        std::size_t lanes() const { return numLanes; }
+
+        // Access to the INPUT and OUTPUT nodes of a single lane
+        void setInput(const std::size_t idx, const std::size_t lane, const double value) { inputs[idx * numLanes + lane] = value; }
+        double getOutput(const std::size_t idx, const std::size_t lane) const { return values[(offset + prog.outputSlots[idx]) * numLanes + lane]; }
+
+        // Access to the INPUT and OUTPUT nodes of all lanes (arrays of size lanes())
+        double* inputLanes(const std::size_t idx) { return &inputs[idx * numLanes]; }
+        const double* outputLanes(const std::size_t idx) const { return &values[(offset + prog.outputSlots[idx]) * numLanes]; }
+
+        // Evaluates all nodes of all lanes once
+        void step();
+
+        const Program& program() const { return prog; }
+
+    protected:
+        Program prog;
+        std::size_t numLanes;
+        std::vector<std::uint32_t> sources[2];
+        std::vector<double> values;
+        std::vector<double> merged;
+        std::vector<double> inputs;
+        // Buffer written by the last step and its offset (in slots) into values
+        std::size_t buffer;
+        std::size_t offset;
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef _BEHAVIOUR_BINARY_HPP
+#define _BEHAVIOUR_BINARY_HPP
+
+#include "BehaviorProgram.hpp"
+
+namespace Behavior {
+
+/*
+    Binary format of compiled programs (.bgb)
+
+    A file consists of a Header followed by these sections (each starting at a multiple of 8 bytes):
+    - Node[nodes], Merge[merges], Edge[edges]           fixed-width records
+    - double bias[merges], default[merges], weight[edges]
+    - uint32 levelBegin[levels]                          (see Program)
+    - uint32 inputNames[inputs], outputNames[outputs]   offsets into the string table
+    - uint32 outputSlots[outputs]
+    - uint32 externNames[externs]                      offsets into the string table (the bindings are not stored, see bindExterns)
+    - char strings[strings]                             NUL-terminated, every string is stored once
+    All integers and doubles are stored in the byte order of the machine, files of the other byte order are rejected.
+    The records only refer to each other by index, so a file is read by copying the sections and interning the strings of the table.
+*/
+namespace Binary {
+
+static const std::uint32_t Magic = 0x42504742; // "BGPB"
+static const std::uint32_t Version = 2;
+
+struct Header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint8_t precision;
+    std::uint8_t feedback;
+    std::uint16_t reserved;
+    std::uint32_t name;
+    std::uint32_t nodes;
+    std::uint32_t merges;
+    std::uint32_t edges;
+    std::uint32_t slots;
+    std::uint32_t levels;
+    std::uint32_t inputs;
+    std::uint32_t outputs;
+    std::uint32_t strings;
+    std::uint32_t externs;
+};
+
+struct Node
+{
+    std::uint8_t op;
+    std::uint8_t reserved[3];
+    std::uint32_t mergeBegin;
+    std::uint32_t slotBegin;
+    std::uint32_t port;
+    std::uint32_t name;
+    std::uint32_t uid;
+};
+
+struct Merge
+{
+    std::uint8_t op;
+    std::uint8_t reserved[3];
+    std::uint32_t edgeBegin;
+    std::uint32_t uid;
+};
+
+struct Edge
+{
+    std::uint32_t source;
+    std::uint8_t delayed;
+    std::uint8_t reserved[3];
+    std::uint32_t uid;
+};
+
+}
+
+// Serializes a program into the binary format
+std::string serializeProgram(const Program& program);
+// Reads a program from the binary format
+// NOTE: Returns an empty program if the data is not a valid program of this version
+Program deserializeProgram(const char* data, const std::size_t size);
+
+// Writes a program into a file. Returns false if the file could not be written
+bool saveProgram(const Program& program, const std::string& fileName);
+// Maps a file into memory and reads the program from it
+// NOTE: Returns an empty program if the file could not be read or is invalid
+Program loadProgram(const std::string& fileName);
+
+}
+
+#endif
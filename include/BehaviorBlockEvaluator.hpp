@@ -0,0 +1,67 @@
+#ifndef _BEHAVIOUR_BLOCK_EVALUATOR_HPP
+#define _BEHAVIOUR_BLOCK_EVALUATOR_HPP
+
+#include "BehaviorProgram.hpp"
+
+namespace Behavior {
+
+/*
+    The BlockEvaluator executes a Program over blocks of consecutive steps (e.g. a buffer of audio samples).
+    Every node which is not part of a cycle processes the whole block at once, so it is dispatched once per block instead of once per step.
+    The nodes of a cycle read the previous step of each other (feedback edges have a delay of one step), so they are evaluated
+    step by step. A block yields the same outputs as blockSize() calls of Evaluator::step
+    (bit for bit with SimdLevel::SCALAR, see Evaluator).
+
+    Every value slot stores [last step of the previous block | the steps of this block] and the edges read their source
+    either at the same step or (if delayed) at the step before.
+*/
+class BlockEvaluator
+{
+    public:
+        BlockEvaluator(const Program& program, const std::size_t blockSize);
+        ~BlockEvaluator();
+
+        // Sets all node outputs, merge results and inputs back to zero
+        void reset();
+
+        std::size_t blockSize() const { return size; }
+        // Number of nodes which are part of a cycle (and therefore evaluated step by step)
+        std::size_t cyclicNodes() const { return numCyclic; }
+
+        // Access to the INPUT and OUTPUT nodes (see Program::inputIndex and Program::outputIndex), one value per step of the block
+        double* inputBlock(const std::size_t idx) { return &inputs[idx * size]; }
+        const double* outputBlock(const std::size_t idx) const { return &values[prog.outputSlots[idx] * stride + 1]; }
+
+        // Evaluates all nodes for blockSize() steps
+        void process();
+
+        const Program& program() const { return prog; }
+
+    protected:
+        // The nodes [begin, end) of order, either all of them outside of cycles or all inside
+        struct Group
+        {
+            std::uint32_t begin;
+            std::uint32_t end;
+            bool cyclic;
+        };
+
+        void processBlock(const Group& group);
+        void processSteps(const Group& group);
+
+        Program prog;
+        std::size_t size;
+        std::size_t stride;
+        std::size_t numCyclic;
+        std::vector<std::uint32_t> order;
+        std::vector<Group> groups;
+        // Position of every edge source in values (relative to the first step of a block, see stride)
+        std::vector<std::uint32_t> edgeOffset;
+        std::vector<double> values;
+        std::vector<double> merged;
+        std::vector<double> inputs;
+};
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _BEHAVIOUR_CODEGEN_HPP
+#define _BEHAVIOUR_CODEGEN_HPP
+
+#include "BehaviorProgram.hpp"
+
+namespace Behavior {
+
+/*
+    Generates a self-contained C++ header evaluating a Program ahead of time.
+
+    The header defines (in namespace 'name')
+    - the sizes and names of the interface as constexpr,
+    - the weights, biases and defaults as constexpr arrays,
+    - a State struct holding all node outputs (with a fixed size),
+    - reset(state) and step(state, inputs, outputs).
+    step() is straight-line code in evaluation order, so the compiler can inline and vectorize everything.
+    The results equal those of an Evaluator with SimdLevel::SCALAR (the vectorized merges sum up in a different order),
+    as long as the compiler does not contract multiplications and additions (GCC does in GNU modes, see -ffp-contract=off).
+
+    With Precision::HIGH or LOW the header includes BehaviorFastMath.hpp.
+    NOTE: Returns an empty string if the program contains nodes which can not be generated (EXTERN, SUBGRAPH)
+*/
+std::string generateCpp(const Program& program, const std::string& name = "");
+
+/*
+    Generates a C++ header defining a Program as a compile-time graph (see BehaviorStatic.hpp).
+
+    The header defines (in namespace 'name') the names of the interface and the type 'Model',
+    so the program is evaluated by Model::reset(state) and Model::step(state, inputs, outputs).
+    This suits small graphs which are evaluated in hot loops; large graphs are expensive to compile.
+    NOTE: Returns an empty string if the program contains nodes which can not be generated (EXTERN, SUBGRAPH)
+    or constants which are not finite.
+*/
+std::string generateStaticCpp(const Program& program, const std::string& name = "");
+
+}
+
+#endif
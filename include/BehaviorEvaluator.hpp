@@ -0,0 +1,114 @@
+#ifndef _BEHAVIOUR_EVALUATOR_HPP
+#define _BEHAVIOUR_EVALUATOR_HPP
+
+#include "BehaviorProgram.hpp"
+#include "BehaviorLayers.hpp"
+#include "BehaviorSimd.hpp"
+#include "BehaviorUpdate.hpp"
+
+#include <map>
+#include <string>
+
+namespace Behavior {
+
+/*
+    The Evaluator executes a compiled Program.
+    All state is allocated on construction, so step() neither allocates nor looks up anything by name.
+    Merges with a large fan-in are computed by vectorized kernels (chosen at runtime, see BehaviorSimd.hpp).
+    These sum up in a different order (and may fuse multiplications and additions), so the BlockEvaluator, the generated code
+    (see BehaviorCodegen.hpp) and Static::Graph, which sum up edge by edge, only match an Evaluator with SimdLevel::SCALAR bit for bit.
+    The ParallelEvaluator matches an Evaluator of the same SimdLevel.
+    If enabled (useLayers), layered regions (see BehaviorLayers.hpp) are evaluated as sparse or dense matrix-vector products
+    followed by the functions of the whole layer. Dense layers sum up in a different order as well, so their results may differ by rounding.
+    Double buffered programs (see Feedback) alternate between two value buffers without copying.
+*/
+class Evaluator
+{
+    public:
+        Evaluator(const Program& program, const SimdLevel level = detectSimdLevel(), const bool useLayers = false);
+        ~Evaluator();
+
+        // Sets all node outputs (of both buffers), merge results and inputs back to zero
+        void reset();
+
+        // Access to the INPUT and OUTPUT nodes (see Program::inputIndex and Program::outputIndex)
+        void setInput(const std::size_t idx, const double value) { inputs[idx] = value; }
+        double getOutput(const std::size_t idx) const { return values[offset + prog.outputSlots[idx]]; }
+
+        // Evaluates all nodes once
+        void step();
+
+        // Demand-driven evaluation of some of the outputs (see Program::outputIndex)
+        // Returns the schedule evaluating only the nodes these outputs need (see Program::demandOf) or Program::npos if an output does not exist.
+        // The schedule of every distinct set of outputs is computed once; it stays valid across updates (the outputs are kept by name).
+        std::size_t demand(const std::vector<std::size_t>& outputs);
+        // Evaluates the nodes of a schedule once
+        // NOTE: All other nodes keep the values of the last step evaluating them (so do the outputs not requested),
+        //       double buffered programs copy them into the buffer written by this step
+        void step(const std::size_t schedule);
+
+        // Applies changes of the model (see BehaviorUpdate.hpp) keeping the state of all nodes
+        // Parameters are patched in place and so are new edges if their source is on an earlier level than their reader.
+        // Any other new edge re-plans the program (it may become a feedback edge then, see breakCycles).
+        // Parameter updates of a uid occurring several times (e.g. in every instance of a SUBGRAPH) change all of them,
+        // a new edge needs a unique MERGE and source NODE.
+        // Returns false if an update refers to something which does not exist or is ambiguous (the updates before it have been applied)
+        // NOTE: A re-plan may renumber the inputs and outputs (see Program::inputIndex and Program::outputIndex)
+        bool update(const Updates& updates);
+
+        const Program& program() const { return prog; }
+        // Node outputs of the last step (program.slots() values)
+        const double* slotValues() const { return values.data() + offset; }
+        const std::vector<double>& mergeValues() const { return merged; }
+        // Layers evaluated in bulk (empty if disabled)
+        const LayerPlan& layerPlan() const { return plan; }
+
+    protected:
+        // The entities of each uid: entries[begin[s], begin[s+1]) for symbol s of the program
+        struct UidIndex
+        {
+            std::vector<std::uint32_t> begin;
+            std::vector<std::uint32_t> entries;
+        };
+
+        // Consecutive nodes [begin, end) of a schedule; a whole layer of the plan is evaluated in bulk (otherwise layer is Program::npos)
+        // and the nodes of the layer not demanded get their values back afterwards
+        struct Segment
+        {
+            std::uint32_t begin;
+            std::uint32_t end;
+            std::size_t layer;
+            std::vector<std::uint32_t> skipped;
+        };
+
+        std::vector<Segment> scheduleOf(const std::vector<std::string>& outputs) const;
+        bool applyUpdates(const Updates& updates);
+        bool addEdge(const Update& change);
+        void replan(const Netlist& netlist);
+        void reindex();
+
+        Program prog;
+        MergeKernel mergeKernel;
+        DenseKernel denseKernel;
+        bool layered;
+        LayerPlan plan;
+        std::vector<std::uint32_t> sources[2];
+        std::vector<double> values;
+        std::vector<double> merged;
+        std::vector<double> inputs;
+        // The values of the skipped nodes of a layer evaluated in bulk (see Segment)
+        std::vector<double> kept;
+        // Buffer written by the last step and its offset into values
+        std::size_t buffer;
+        std::size_t offset;
+        UidIndex nodesByUid;
+        UidIndex mergesByUid;
+        UidIndex edgesByUid;
+        // The schedules and the names of their outputs (see demand)
+        std::vector< std::vector<Segment> > schedules;
+        std::map<std::vector<std::string>, std::size_t> schedulesByOutputs;
+};
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _BEHAVIOUR_EXTERN_H
+#define _BEHAVIOUR_EXTERN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    C interface of the native functions behind EXTERN nodes (see BehaviorExtern.hpp)
+
+    A call evaluates one EXTERN node for 'lanes' instances at once: the lanes of a BatchEvaluator,
+    the steps of a block (BlockEvaluator) or a single lane (Evaluator).
+    Input i of lane l is inputs[i * inputStride + l], output o of lane l has to be written to outputs[o * outputStride + l].
+    Inputs and outputs are the interfaces of the EXTERN class ordered by their labels: indices (the idx of the bg format)
+    by value first, then names alphabetically. Every input is passed, unconnected ones yield the default of their merge (0 without a merge).
+    The spans are owned by the evaluator and only valid during the call.
+
+    A ParallelEvaluator calls the functions from all of its threads, so different EXTERN nodes (even of the same function)
+    may be evaluated at the same time. Functions and the contexts they share have to be reentrant then.
+*/
+typedef struct
+{
+    const double* inputs;
+    size_t inputStride;
+    size_t numInputs;
+    double* outputs;
+    size_t outputStride;
+    size_t numOutputs;
+    size_t lanes;
+} BehaviorExternCall;
+
+typedef void (*BehaviorExternFunction)(void* context, const BehaviorExternCall* call);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
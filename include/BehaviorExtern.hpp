@@ -0,0 +1,45 @@
+#ifndef _BEHAVIOUR_EXTERN_HPP
+#define _BEHAVIOUR_EXTERN_HPP
+
+#include "BehaviorExtern.h"
+
+#include <map>
+#include <string>
+
+namespace Behavior {
+
+class Program;
+
+// A native function together with the context passed to every call
+struct ExternBinding
+{
+    BehaviorExternFunction function;
+    void* context;
+};
+
+/*
+    The ExternRegistry maps the names of EXTERN classes (extern_name in the bg files) to native functions.
+    Programs look up their EXTERN nodes once (see bindExterns), so evaluating such a node costs one indirect call
+    per step (or per batch or block) and neither allocates nor looks up anything.
+*/
+class ExternRegistry
+{
+    public:
+        // Binds a function to an extern name (replacing any previous binding)
+        void bind(const std::string& externName, const BehaviorExternFunction function, void* context = NULL);
+        void unbind(const std::string& externName);
+        // Returns NULL if nothing is bound to the name
+        const ExternBinding* find(const std::string& externName) const;
+
+    private:
+        std::map<std::string, ExternBinding> bindings;
+};
+
+// Binds the EXTERN nodes of a program to the functions of a registry
+// Returns the number of EXTERN nodes which are not bound (they yield zeros)
+// NOTE: Evaluators copy their program, so the program has to be bound before they are constructed
+std::size_t bindExterns(Program& program, const ExternRegistry& registry);
+
+}
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef _BEHAVIOUR_FAST_MATH_HPP
+#define _BEHAVIOUR_FAST_MATH_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace Behavior {
+
+// Accuracy of the built-in node functions (selected per Program)
+enum class Precision : std::uint8_t
+{
+    EXACT,  // libm
+    HIGH,   // errors around 1e-6 or better
+    LOW     // errors around 1e-3 or better
+};
+
+/*
+    Polynomial approximations of the built-in node functions.
+
+    All functions are branch free (range reduction, polynomial, reconstruction by bit manipulation),
+    so loops over them are vectorized by the compiler. The errors are absolute for sin, cos, tanh and atan(2)
+    and relative for exp, log and pow. The range reduction of sin and cos is exact for |x| < 1e6.
+    With Precision::EXACT the libm functions are used.
+*/
+namespace FastMath {
+
+static const double Magic = 6755399441055744.0; // 1.5 * 2^52
+static const double Ln2Hi = 0.6931471803691238;
+static const double Ln2Lo = 1.9082149292705877e-10;
+static const double Log2e = 1.4426950408889634;
+static const double Sqrt2 = 1.4142135623730951;
+static const double Sqrt3 = 1.7320508075688772;
+static const double TwoMinusSqrt3 = 0.2679491924311227;
+static const double TwoOverPi = 0.6366197723675814;
+static const double PiOver2Hi = 1.5707963267341256;
+static const double PiOver2Mid = 6.077100506303966e-11;
+static const double PiOver2Lo = 2.0222662487959506e-21;
+static const double Pi = 3.141592653589793;
+static const double PiOver2 = 1.5707963267948966;
+static const double PiOver6 = 0.5235987755982989;
+
+inline std::uint64_t bitsOf(const double x)
+{
+    std::uint64_t b;
+    std::memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+inline double fromBits(const std::uint64_t b)
+{
+    double x;
+    std::memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+// Rounds to the nearest integer (valid for |x| < 2^51)
+inline double roundToInt(const double x)
+{
+    return (x + Magic) - Magic;
+}
+
+// Returns the lowest bits of an integral double (as produced by roundToInt)
+inline std::uint64_t lowBitsOf(const double k)
+{
+    return bitsOf(k + Magic);
+}
+
+template<Precision P> inline double exp(const double x)
+{
+    if (P == Precision::EXACT)
+        return std::exp(x);
+    // Beyond these bounds the result is 0 or inf anyway (they keep k within the range of the two scales below)
+    const double xc(x < -746.0 ? -746.0 : (x > 710.0 ? 710.0 : x));
+    const double k(roundToInt(xc * Log2e));
+    const double r((xc - k * Ln2Hi) - k * Ln2Lo);
+    // Taylor series of e^r with |r| <= ln(2)/2
+    double p;
+    if (P == Precision::LOW)
+        p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24))));
+    else
+        p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120 + r * (1.0 / 720 + r * (1.0 / 5040)))))));
+    // 2^k = 2^(k - h) * 2^h is constructed by writing the exponents + 1023 into the exponent fields
+    // Both factors are normal numbers, so only the last multiplication rounds (overflows or underflows into the subnormals)
+    const double h(roundToInt(0.5 * k));
+    const double scaleLo(fromBits(lowBitsOf(k - h + 1023.0) << 52));
+    const double scaleHi(fromBits(lowBitsOf(h + 1023.0) << 52));
+    return (p * scaleLo) * scaleHi;
+}
+
+template<Precision P> inline double log(const double x)
+{
+    if (P == Precision::EXACT)
+        return std::log(x);
+    // Scale subnormals into the normal range
+    const bool isSubnormal(x < std::numeric_limits<double>::min());
+    const std::uint64_t b(bitsOf(isSubnormal ? x * 4503599627370496.0 : x));
+    // x = m * 2^e with m in [sqrt(0.5), sqrt(2))
+    double m(fromBits((b & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull));
+    double e(fromBits(((b >> 52) & 0x7FF) | 0x4330000000000000ull) - (4503599627370496.0 + 1023.0));
+    e = isSubnormal ? e - 52.0 : e;
+    const bool isLarge(m > Sqrt2);
+    m = isLarge ? m * 0.5 : m;
+    e = isLarge ? e + 1.0 : e;
+    // log(m) = 2 atanh(s) with |s| <= 0.1716
+    const double s((m - 1.0) / (m + 1.0));
+    const double z(s * s);
+    double p;
+    if (P == Precision::LOW)
+        p = 2.0 * s * (1.0 + z * (1.0 / 3));
+    else
+        p = 2.0 * s * (1.0 + z * (1.0 / 3 + z * (1.0 / 5 + z * (1.0 / 7 + z * (1.0 / 9)))));
+    const double result(e * Ln2Hi + (e * Ln2Lo + p));
+    if (x > 0.0)
+        return x < std::numeric_limits<double>::infinity() ? result : x;
+    return x == 0.0 ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+}
+
+// Computes sin(x + quadrant * pi/2)
+template<Precision P> inline double sinQuadrant(const double x, const std::uint64_t quadrant)
+{
+    const double k(roundToInt(x * TwoOverPi));
+    const double r(((x - k * PiOver2Hi) - k * PiOver2Mid) - k * PiOver2Lo);
+    const std::uint64_t q(lowBitsOf(k) + quadrant);
+    // Taylor series of sin(r) and cos(r) with |r| <= pi/4
+    const double z(r * r);
+    double s, c;
+    if (P == Precision::LOW)
+    {
+        s = r * (1.0 - z * (1.0 / 6 - z * (1.0 / 120)));
+        c = 1.0 - z * (1.0 / 2 - z * (1.0 / 24));
+    } else {
+        s = r * (1.0 - z * (1.0 / 6 - z * (1.0 / 120 - z * (1.0 / 5040 - z * (1.0 / 362880)))));
+        c = 1.0 - z * (1.0 / 2 - z * (1.0 / 24 - z * (1.0 / 720 - z * (1.0 / 40320))));
+    }
+    const double v((q & 1) ? c : s);
+    return (q & 2) ? -v : v;
+}
+
+template<Precision P> inline double sin(const double x)
+{
+    if (P == Precision::EXACT)
+        return std::sin(x);
+    return sinQuadrant<P>(x, 0);
+}
+
+template<Precision P> inline double cos(const double x)
+{
+    if (P == Precision::EXACT)
+        return std::cos(x);
+    return sinQuadrant<P>(x, 1);
+}
+
+template<Precision P> inline double tanh(const double x)
+{
+    if (P == Precision::EXACT)
+        return std::tanh(x);
+    const double xc(x < -20.0 ? -20.0 : (x > 20.0 ? 20.0 : x));
+    const double e(exp<P>(2.0 * xc));
+    return (e - 1.0) / (e + 1.0);
+}
+
+template<Precision P> inline double atan2(const double y, const double x)
+{
+    if (P == Precision::EXACT)
+        return std::atan2(y, x);
+    const double ax(x < 0.0 ? -x : x);
+    const double ay(y < 0.0 ? -y : y);
+    const double mx(ax > ay ? ax : ay);
+    const double mn(ax > ay ? ay : ax);
+    const double t(mx > 0.0 ? mn / mx : 0.0);
+    // atan(t) = pi/6 + atan((sqrt(3) t - 1) / (t + sqrt(3))) reduces t to |u| <= 2 - sqrt(3)
+    const bool isLarge(t > TwoMinusSqrt3);
+    const double u(isLarge ? (Sqrt3 * t - 1.0) / (t + Sqrt3) : t);
+    const double z(u * u);
+    double p;
+    if (P == Precision::LOW)
+        p = u * (1.0 - z * (1.0 / 3 - z * (1.0 / 5)));
+    else
+        p = u * (1.0 - z * (1.0 / 3 - z * (1.0 / 5 - z * (1.0 / 7 - z * (1.0 / 9)))));
+    double a(isLarge ? PiOver6 + p : p);
+    a = ay > ax ? PiOver2 - a : a;
+    a = x < 0.0 ? Pi - a : a;
+    return y < 0.0 ? -a : a;
+}
+
+template<Precision P> inline double atan(const double x)
+{
+    if (P == Precision::EXACT)
+        return std::atan(x);
+    return atan2<P>(x, 1.0);
+}
+
+template<Precision P> inline double pow(const double x, const double y)
+{
+    if (P == Precision::EXACT)
+        return std::pow(x, y);
+    const double ax(x < 0.0 ? -x : x);
+    const double r(exp<P>(y * log<P>(ax)));
+    // Negative bases are only defined for integral exponents
+    const double ay(y < 0.0 ? -y : y);
+    const bool isHuge(ay >= 4503599627370496.0);
+    const double yi(isHuge ? y : roundToInt(y));
+    const bool isIntegral(yi == y);
+    const bool isOdd(!isHuge && (lowBitsOf(yi) & 1));
+    double result(x < 0.0 ? (isIntegral ? (isOdd ? -r : r) : std::numeric_limits<double>::quiet_NaN()) : r);
+    result = x == 0.0 ? (y > 0.0 ? 0.0 : std::numeric_limits<double>::infinity()) : result;
+    return y == 0.0 ? 1.0 : result;
+}
+
+// Vectorized versions: y[i] = f(x[i]) for all i < n
+void sin(const double* x, double* y, const std::size_t n, const Precision p);
+void cos(const double* x, double* y, const std::size_t n, const Precision p);
+void tanh(const double* x, double* y, const std::size_t n, const Precision p);
+void exp(const double* x, double* y, const std::size_t n, const Precision p);
+void log(const double* x, double* y, const std::size_t n, const Precision p);
+void atan(const double* x, double* y, const std::size_t n, const Precision p);
+// z[i] = atan2(y[i], x[i]) and z[i] = pow(x[i], y[i]) for all i < n
+void atan2(const double* y, const double* x, double* z, const std::size_t n, const Precision p);
+void pow(const double* x, const double* y, double* z, const std::size_t n, const Precision p);
+
+}
+
+}
+
+#endif
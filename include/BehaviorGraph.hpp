@@ -2,6 +2,13 @@
 #define _BEHAVIOUR_GRAPH_HPP
 
 #include "SoftwareNetwork.hpp"
+#include "BehaviorProgram.hpp"
+#include "BehaviorUpdate.hpp"
+
+#include <istream>
+#include <map>
+#include <thread>
+#include <unordered_map>
 
 namespace Behavior {
 
@@ -28,48 +35,98 @@ class Graph : public Software::Network
         //static const UniqueId VHDLValueId;
 
         // The following are built-ins
-        //static const UniqueId SumId;
-        //static const UniqueId ProductId;
-        //static const UniqueId MinId;
-        //static const UniqueId MaxId;
-        //static const UniqueId MeanId;
-        //static const UniqueId NormId;
-
-        //static const UniqueId Arity1Id;
-        //static const UniqueId PipeId;
+        static const UniqueId SumId;
+        static const UniqueId ProductId;
+        static const UniqueId MinId;
+        static const UniqueId MaxId;
+        static const UniqueId MeanId;
+        static const UniqueId NormId;
+
+        static const UniqueId Arity1Id;
+        static const UniqueId PipeId;
         static const UniqueId InputNodeId;
         static const UniqueId OutputNodeId;
-        //static const UniqueId DivideId;
-        //static const UniqueId SineId;
-        //static const UniqueId CosineId;
-        //static const UniqueId TangensId;
-        //static const UniqueId TangensHyperbolicusId;
-        //static const UniqueId ArcusCosineId;
-        //static const UniqueId ArcusSineId;
-        //static const UniqueId ArcusTangensId;
-        //static const UniqueId LogarithmId;
-        //static const UniqueId ExponentialId;
-        //static const UniqueId AbsoluteId;
-        //static const UniqueId SquareRootId;
-
-        //static const UniqueId Arity2Id;
-        //static const UniqueId ArcusTangens2Id;
-        //static const UniqueId PowerId;
-        //static const UniqueId ModuloId;
-
-        //static const UniqueId Arity3Id;
-        //static const UniqueId GreaterZeroId;
-        //static const UniqueId ApproxZeroId;
+        static const UniqueId DivideId;
+        static const UniqueId SineId;
+        static const UniqueId CosineId;
+        static const UniqueId TangensId;
+        static const UniqueId TangensHyperbolicusId;
+        static const UniqueId ArcusCosineId;
+        static const UniqueId ArcusSineId;
+        static const UniqueId ArcusTangensId;
+        static const UniqueId LogarithmId;
+        static const UniqueId ExponentialId;
+        static const UniqueId AbsoluteId;
+        static const UniqueId SquareRootId;
+
+        static const UniqueId Arity2Id;
+        static const UniqueId ArcusTangens2Id;
+        static const UniqueId PowerId;
+        static const UniqueId ModuloId;
 
+        static const UniqueId Arity3Id;
+        static const UniqueId GreaterZeroId;
+        static const UniqueId ApproxZeroId;
+
+        // A new graph starts as a copy of the meta model, which is built only once (see metaModel)
         Graph();
+        // Adds the meta model to a copy of base (unless base contains it already, e.g. the hypergraph of another Graph)
         Graph(const Hypergraph& base);
         ~Graph();
 
+        // The NODE, MERGE and EDGE classes and all built-ins (built on first use, shared by all threads)
+        static const Hypergraph& metaModel();
+
         std::string exportModel(const UniqueId& uid) const;
         UniqueId importModel(const std::string& serializedModel);
+        // Imports a model from a stream without loading the whole document first (its entries are kept until it has been parsed)
+        // Edges may refer to nodes which come later. Returns an empty uid and leaves the graph untouched if the document is malformed.
+        UniqueId importModel(std::istream& stream);
+        // Imports many models at once: The files are parsed concurrently by up to 'threads' threads, then the models are created
+        // one after another, every model after the models defining its SUBGRAPH nodes (by subgraph_name) and otherwise in the given order.
+        // Returns the uids of the models in the order of the files (an empty uid if a file could not be read or parsed)
+        Hyperedges importModels(const std::vector<std::string>& fileNames, const std::size_t threads = std::thread::hardware_concurrency());
+        // Exports several SUBGRAPH classes concurrently (exporting only reads the graph)
+        std::vector<std::string> exportModels(const Hyperedges& uids, const std::size_t threads = std::thread::hardware_concurrency()) const;
+
+        // Lowers the NODE, MERGE and EDGE instances of a SUBGRAPH into a netlist
+        // NOTE: Nested SUBGRAPH nodes are kept as they are (see flattenModel), EXTERN nodes call native functions (see BehaviorExtern.hpp)
+        // NOTE: Returns an empty netlist if the SUBGRAPH contains nodes or merges of unknown classes
+        Netlist lowerModel(const UniqueId& uid) const;
+        // Lowers a SUBGRAPH and recursively inlines all nested SUBGRAPH nodes (see inlineSubgraphs and removePipes)
+        // If a cache is given, every SUBGRAPH class is flattened only once and the result is reused by later calls
+        // NOTE: The cache has to be cleared whenever the SUBGRAPH classes change
+        Netlist flattenModel(const UniqueId& uid, std::map<UniqueId, Netlist>* cache = NULL) const;
+        // Compiles a (flattened) SUBGRAPH into an executable program (see BehaviorEvaluator.hpp)
+        Program compileModel(const UniqueId& uid, const Precision precision = Precision::EXACT, const Feedback feedback = Feedback::IN_PLACE) const;
+
+        // The numbers held by the value entities of the interfaces (weights, biases and defaults)
+        // Values are stored as numbers, their labels are only written by storeRealValues (e.g. before the hypergraph is serialized).
+        // Values which have never been set (e.g. of a loaded hypergraph) are read from their label.
+        double realValueOf(const UniqueId& valueUid, const double fallback = 0.0) const;
+        void setRealValue(const UniqueId& valueUid, const double value);
+        void storeRealValues();
+        // Destroys an entity and forgets its number (if it is a value)
+        // NOTE: Numbers of values destroyed through the Hypergraph itself are ignored as long as their uid does not exist
+        //       and dropped by storeRealValues
+        void destroy(const UniqueId& uid);
+
+        // Applies changes to the MERGE and EDGE instances (see BehaviorUpdate.hpp), so that the model matches an updated Evaluator
+        // The uids of new edges are stored in Update::edge. New edges are part of the SUBGRAPH of their merge.
+        // Returns false if an update refers to something which does not exist (the updates before it have been applied)
+        // NOTE: A flatten cache (see flattenModel) has to be cleared afterwards
+        bool update(Updates& updates);
 
     protected:
         void setupMetaModel();
+
+    private:
+        struct Prototype {};
+        // Builds the meta model from scratch
+        Graph(const Prototype&);
+
+        // Value uid -> number (see realValueOf)
+        std::unordered_map<UniqueId, double> realValues;
 };
 
 }
@@ -0,0 +1,50 @@
+#ifndef _BEHAVIOUR_LAYERS_HPP
+#define _BEHAVIOUR_LAYERS_HPP
+
+#include "BehaviorProgram.hpp"
+
+namespace Behavior {
+
+/*
+    Layered regions of a program (evaluated in bulk by the Evaluator).
+
+    Many models are effectively neural layers: banks of merges fed by weighted edges of the previous bank,
+    followed by the same function (e.g. TANH). The nodes of one level applying the same built-in function form such a layer.
+    Its merges are the rows of a sparse matrix over the value slots: since the edges of consecutive merges are stored consecutively,
+    the program already holds this matrix in CSR format (mergeEdgeBegin, edgeSource, edgeWeight).
+    If all merges of a layer are SUMs and their edges cover at least DenseLayerThreshold of the spanned slots,
+    the matrix is stored dense instead, so it can be multiplied without gathering the values.
+    Its unconnected entries are zeros, so steps in which a spanned slot is infinite or NaN fall back to the sparse matrix.
+    The nodes of a layer do not depend on each other, so all merges are computed first and then all nodes
+    (functions of a single input are computed for the whole layer at once).
+*/
+struct Layer
+{
+    std::uint32_t nodeBegin;
+    std::uint32_t nodeEnd;
+    // Dense layers use the weights [denseBegin, denseBegin + merges * columns) of LayerPlan::denseWeights (row major)
+    // over the slots [columnBegin, columnBegin + columns)
+    bool dense;
+    std::uint32_t columnBegin;
+    std::uint32_t columns;
+    std::size_t denseBegin;
+};
+
+struct LayerPlan
+{
+    std::vector<Layer> layers;
+    std::vector<double> denseWeights;
+};
+
+// Smaller runs of nodes are left to the generic evaluation
+static const std::size_t MinLayerNodes = 4;
+// Minimum share of the spanned slots a dense layer reads
+static const double DenseLayerThreshold = 0.25;
+
+// Finds the layers of a program (in evaluation order)
+// NOTE: Dense layers copy the weights, so the plan has to be renewed whenever the program changes
+LayerPlan planLayers(const Program& program);
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef _BEHAVIOUR_NETLIST_HPP
+#define _BEHAVIOUR_NETLIST_HPP
+
+#include "Hypergraph.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Behavior {
+
+// Operations of the built-in NODE classes (see Graph::setupMetaModel)
+enum class NodeOp : std::uint8_t
+{
+    // Arity 1
+    PIPE,
+    INPUT,
+    OUTPUT,
+    DIVIDE,
+    SIN,
+    COS,
+    TAN,
+    TANH,
+    ACOS,
+    ASIN,
+    ATAN,
+    LOG,
+    EXP,
+    ABS,
+    SQRT,
+    // Arity 2
+    ATAN2,
+    POW,
+    MOD,
+    // Arity 3
+    GREATER_ZERO,
+    APPROX_ZERO,
+    // Non built-ins
+    EXTERN,
+    SUBGRAPH
+};
+
+// Operations of the built-in MERGE classes
+enum class MergeOp : std::uint8_t
+{
+    SUM,
+    PRODUCT,
+    MIN,
+    MAX,
+    MEAN,
+    NORM
+};
+
+// Returns the number of inputs of a built-in node operation
+// NOTE: INPUT nodes get their value from outside, so they have no merged input
+std::size_t arityOf(const NodeOp op);
+
+// Returns the name of an operation (e.g. "TANH" or "SUM")
+std::string nameOf(const NodeOp op);
+std::string nameOf(const MergeOp op);
+
+// Values with a magnitude below this threshold are considered zero by the ==0 node
+static const double ApproxZeroEpsilon = 1e-9;
+
+/*
+    A Netlist is the flat, index based form of a SUBGRAPH.
+    Every node owns one merge per input and every merge owns its incoming edges.
+    Edges refer to their source by node index and output index.
+    Delayed edges read the value of the previous step. They break the cycles of the graph (see breakCycles).
+    This is the intermediate form between the hypergraph and a compiled Program.
+*/
+struct Netlist
+{
+    struct Edge
+    {
+        std::size_t fromNode;
+        std::size_t fromOutput;
+        double weight;
+        UniqueId uid;
+        bool delayed;
+    };
+
+    struct Merge
+    {
+        MergeOp op;
+        double bias;
+        double defaultValue;
+        std::vector<Edge> edges;
+        UniqueId uid;
+    };
+
+    struct Node
+    {
+        NodeOp op;
+        std::string name;
+        UniqueId uid;
+        UniqueId classUid;
+        std::vector<std::string> inputNames;
+        std::vector<Merge> inputs;
+        std::vector<std::string> outputNames;
+        // The extern_name of EXTERN nodes (see BehaviorExtern.hpp)
+        std::string externName;
+    };
+
+    std::string name;
+    std::vector<Node> nodes;
+
+    bool empty() const { return nodes.empty(); }
+};
+
+// Returns the nodes which depend on the outputs of each node (self loops and delayed edges excluded)
+std::vector< std::vector<std::size_t> > successorsOf(const Netlist& netlist);
+
+// Finds the strongly connected components given the successors of every node
+// Returns the component of every node; components are numbered in reverse topological order.
+std::vector<std::size_t> componentsOf(const std::vector< std::vector<std::size_t> >& successors, std::size_t& count);
+
+// Marks edges as delayed until the remaining edges are acyclic and returns their number
+// Every cycle is entered where it is fed from outside, the edges closing the cycle there are the delayed ones.
+std::size_t breakCycles(Netlist& netlist);
+
+// Removes the given nodes (removed[i] for node i) together with all edges leaving them
+void removeNodes(Netlist& netlist, const std::vector<bool>& removed);
+
+// Replaces the SUBGRAPH nodes by the nodes of their bodies (bodies[i] for node i, NULL for all other nodes)
+// The inputs of an instance are wired to the INPUT nodes of the body by name (or else by index, in the order of names),
+// the OUTPUT nodes of the body to the readers of the instance outputs. Both become PIPEs, the inner nodes are named <instance>/<node>.
+// NOTE: The bodies have to be flat already and SUBGRAPH nodes without a body are removed
+Netlist inlineSubgraphs(const Netlist& netlist, const std::vector<const Netlist*>& bodies);
+
+// Removes PIPE nodes by connecting their readers directly to their source
+// Only PIPEs passing a single edge through a SUM merge without bias are removed and only if no weight has to be rounded
+// and the delays of the edges can be combined.
+// Returns the number of removed nodes (and appends their names to removedNames if given)
+std::size_t removePipes(Netlist& netlist, std::vector<std::string>* removedNames = NULL);
+
+// Serializes a netlist in the .bg format read by Graph::importModel (nodes are referred to by index + 1)
+// Delays are not stored, they are found again by breakCycles after importing.
+// NOTE: Returns an empty string if the netlist contains SUBGRAPH nodes (see inlineSubgraphs)
+std::string exportNetlist(const Netlist& netlist);
+
+}
+
+#endif
@@ -0,0 +1,337 @@
+#ifndef _BEHAVIOUR_NUMERIC_HPP
+#define _BEHAVIOUR_NUMERIC_HPP
+
+#include "BehaviorProgram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Behavior {
+
+/*
+    Numeric backends of the NumericEvaluator.
+
+    A backend defines the type of all values (Value) and the arithmetic of the merges and nodes on it:
+    FloatingPoint<float> and FloatingPoint<double> compute everything in the respective type,
+    FixedPoint computes in Qm.n (m integer bits, n fractional bits and a sign bit) with round to nearest and saturation,
+    as the arithmetic of an FPGA port would do. Backends count their saturated results (floating point never saturates).
+*/
+template<typename T> class FloatingPoint
+{
+    public:
+        typedef T Value;
+
+        std::string format() const { return sizeof(T) == sizeof(float) ? "float" : "double"; }
+
+        std::uint64_t saturations() const { return 0; }
+        void resetSaturations() {}
+
+        Value fromReal(const double x) { return static_cast<T>(x); }
+        double toReal(const Value x) const { return x; }
+
+        Value add(const Value a, const Value b) { return a + b; }
+        Value multiply(const Value a, const Value b) { return a * b; }
+        Value divide(const Value a, const std::size_t n) { return a / static_cast<T>(n); }
+        Value sqrt(const Value x) { return std::sqrt(x); }
+
+        // Computes the output of a built-in node given its merged inputs (see applyNode)
+        Value apply(const NodeOp op, const Value* in)
+        {
+            switch (op)
+            {
+                case NodeOp::PIPE:
+                case NodeOp::OUTPUT:
+                    return in[0];
+                case NodeOp::DIVIDE:
+                    return static_cast<T>(1) / in[0];
+                case NodeOp::SIN:
+                    return std::sin(in[0]);
+                case NodeOp::COS:
+                    return std::cos(in[0]);
+                case NodeOp::TAN:
+                    return std::tan(in[0]);
+                case NodeOp::TANH:
+                    return std::tanh(in[0]);
+                case NodeOp::ACOS:
+                    return std::acos(in[0]);
+                case NodeOp::ASIN:
+                    return std::asin(in[0]);
+                case NodeOp::ATAN:
+                    return std::atan(in[0]);
+                case NodeOp::LOG:
+                    return std::log(in[0]);
+                case NodeOp::EXP:
+                    return std::exp(in[0]);
+                case NodeOp::ABS:
+                    return std::fabs(in[0]);
+                case NodeOp::SQRT:
+                    return std::sqrt(in[0]);
+                case NodeOp::ATAN2:
+                    return std::atan2(in[0], in[1]);
+                case NodeOp::POW:
+                    return std::pow(in[0], in[1]);
+                case NodeOp::MOD:
+                    return std::fmod(in[0], in[1]);
+                case NodeOp::GREATER_ZERO:
+                    return in[0] > 0 ? in[1] : in[2];
+                case NodeOp::APPROX_ZERO:
+                    return std::fabs(in[0]) < ApproxZeroEpsilon ? in[1] : in[2];
+                default:
+                    return 0;
+            }
+        }
+};
+
+/*
+    Fixed-point arithmetic in Qm.n stored in 32 bit: value = raw / 2^n, m + n <= 31.
+    Every result which does not fit is saturated to the largest (or smallest) value and counted (see saturations).
+    The node functions are computed exactly and rounded to the format, like a lookup table or CORDIC unit of sufficient width would.
+*/
+class FixedPoint
+{
+    public:
+        typedef std::int32_t Value;
+
+        // The fractional bits are limited to 31, the integer bits to the remaining ones
+        FixedPoint(const unsigned integerBits = 15, const unsigned fractionalBits = 16);
+
+        // Parses "Qm.n" (or "qm.n"). Returns false if the text is not such a format
+        static bool parse(const std::string& text, unsigned& integerBits, unsigned& fractionalBits);
+
+        unsigned integerBits() const { return intBits; }
+        unsigned fractionalBits() const { return fracBits; }
+        std::string format() const;
+        // Smallest step between two values
+        double resolution() const { return std::ldexp(1.0, -static_cast<int>(fracBits)); }
+
+        // Number of saturated results so far
+        std::uint64_t saturations() const { return numSaturated; }
+        void resetSaturations() { numSaturated = 0; }
+
+        Value fromReal(const double x);
+        double toReal(const Value x) const { return std::ldexp(static_cast<double>(x), -static_cast<int>(fracBits)); }
+
+        Value add(const Value a, const Value b) { return saturate(static_cast<std::int64_t>(a) + b); }
+        Value multiply(const Value a, const Value b)
+        {
+            const std::int64_t product(static_cast<std::int64_t>(a) * b);
+            return saturate(fracBits ? (product + (std::int64_t(1) << (fracBits - 1))) >> fracBits : product);
+        }
+        Value divide(const Value a, const std::size_t n)
+        {
+            // Round to nearest like multiply: floor((2a + n) / 2n)
+            const std::int64_t d(2 * static_cast<std::int64_t>(n));
+            const std::int64_t x(2 * static_cast<std::int64_t>(a) + static_cast<std::int64_t>(n));
+            return static_cast<Value>(x >= 0 ? x / d : -((d - 1 - x) / d));
+        }
+        Value sqrt(const Value x) { return fromReal(std::sqrt(toReal(x))); }
+
+        // Computes the output of a built-in node given its merged inputs (see applyNode)
+        Value apply(const NodeOp op, const Value* in);
+
+    private:
+        Value saturate(const std::int64_t raw)
+        {
+            if (raw > maxRaw)
+            {
+                numSaturated++;
+                return static_cast<Value>(maxRaw);
+            }
+            if (raw < minRaw)
+            {
+                numSaturated++;
+                return static_cast<Value>(minRaw);
+            }
+            return static_cast<Value>(raw);
+        }
+
+        unsigned fracBits;
+        unsigned intBits;
+        std::int64_t maxRaw;
+        std::int64_t minRaw;
+        std::uint64_t numSaturated;
+};
+
+/*
+    The NumericEvaluator executes a Program like the Evaluator, but stores and computes all values,
+    weights, biases and defaults in the Value type of a numeric backend (see above).
+    It is meant to check the numeric behavior of a model (e.g. before porting it to fixed-width hardware)
+    and to evaluate large models with half of the memory traffic (float and Q formats store 4 instead of 8 bytes per value).
+    Inputs and outputs are converted from and to double. EXTERN nodes are called with their inputs and outputs converted to double.
+    The node functions are those of libm in the precision of the backend (Program::precision is not used).
+    NumericEvaluator< FloatingPoint<double> > yields the same outputs as the Evaluator without vectorized merges and layers (SimdLevel::SCALAR).
+*/
+template<typename Backend> class NumericEvaluator
+{
+    public:
+        typedef typename Backend::Value Value;
+
+        NumericEvaluator(const Program& program, const Backend& backend = Backend())
+        : prog(program),
+          arithmetic(backend),
+          values(program.slots() * program.buffers(), 0),
+          merged(program.merges(), 0),
+          inputs(program.inputNames.size(), 0),
+          buffer(0),
+          offset(0),
+          numParameterSaturations(0)
+        {
+            for (std::size_t b = 0; b < prog.buffers(); ++b)
+                sources[b] = prog.sourcesOf(b);
+            for (const double weight : prog.edgeWeight)
+                weights.push_back(arithmetic.fromReal(weight));
+            for (std::size_t k = 0; k < prog.merges(); ++k)
+            {
+                biases.push_back(arithmetic.fromReal(prog.mergeBias[k]));
+                defaults.push_back(arithmetic.fromReal(prog.mergeDefault[k]));
+            }
+            // EXTERN nodes are called with doubles
+            std::size_t externInputs(0);
+            std::size_t externOutputs(0);
+            for (std::size_t n = 0; n < prog.nodes(); ++n)
+            {
+                if (prog.nodeOps[n] != NodeOp::EXTERN)
+                    continue;
+                externInputs = std::max<std::size_t>(externInputs, prog.nodeMergeBegin[n+1] - prog.nodeMergeBegin[n]);
+                externOutputs = std::max<std::size_t>(externOutputs, prog.nodeSlotBegin[n+1] - prog.nodeSlotBegin[n]);
+            }
+            externIn.resize(externInputs);
+            externOut.resize(externOutputs);
+            // Parameters out of range are counted on their own, backend().saturations() counts the steps only
+            numParameterSaturations = arithmetic.saturations();
+            arithmetic.resetSaturations();
+        }
+
+        // Sets all node outputs (of both buffers), merge results and inputs back to zero
+        void reset()
+        {
+            std::fill(values.begin(), values.end(), 0);
+            std::fill(merged.begin(), merged.end(), 0);
+            std::fill(inputs.begin(), inputs.end(), 0);
+            buffer = 0;
+            offset = 0;
+        }
+
+        // Access to the INPUT and OUTPUT nodes (see Program::inputIndex and Program::outputIndex)
+        void setInput(const std::size_t idx, const double value) { inputs[idx] = arithmetic.fromReal(value); }
+        double getOutput(const std::size_t idx) const { return arithmetic.toReal(values[offset + prog.outputSlots[idx]]); }
+
+        // Evaluates all nodes once
+        void step()
+        {
+            // Every step writes the buffer read by the next one
+            buffer = (buffer + 1) % prog.buffers();
+            offset = buffer * prog.slots();
+            const std::uint32_t* edgeSource(sources[buffer].data());
+            Value* out(values.data() + offset);
+            for (std::size_t n = 0; n < prog.nodes(); ++n)
+            {
+                const std::uint32_t mergeBegin(prog.nodeMergeBegin[n]);
+                for (std::uint32_t k = mergeBegin; k < prog.nodeMergeBegin[n+1]; ++k)
+                    merged[k] = merge(k, edgeSource);
+
+                const NodeOp op(prog.nodeOps[n]);
+                if (op == NodeOp::INPUT)
+                    out[prog.nodeSlotBegin[n]] = inputs[prog.nodePort[n]];
+                else if (op == NodeOp::EXTERN)
+                    callExtern(n, out + prog.nodeSlotBegin[n]);
+                else
+                    out[prog.nodeSlotBegin[n]] = arithmetic.apply(op, merged.data() + mergeBegin);
+            }
+        }
+
+        const Program& program() const { return prog; }
+        const Backend& backend() const { return arithmetic; }
+        // Number of weights, biases and defaults which had to be saturated
+        std::uint64_t parameterSaturations() const { return numParameterSaturations; }
+        // Bytes of all node outputs, merge results, weights, biases and defaults
+        std::size_t stateBytes() const
+        {
+            return (values.size() + merged.size() + weights.size() + biases.size() + defaults.size()) * sizeof(Value);
+        }
+
+    protected:
+        // Computes merge k in the arithmetic of the backend (see applyMerge)
+        Value merge(const std::size_t k, const std::uint32_t* edgeSource)
+        {
+            const std::uint32_t edgeBegin(prog.mergeEdgeBegin[k]);
+            const std::uint32_t edgeEnd(prog.mergeEdgeBegin[k+1]);
+            if (edgeBegin == edgeEnd)
+                return defaults[k];
+
+            // The first edge initializes the accumulator
+            const MergeOp op(prog.mergeOps[k]);
+            Value result(arithmetic.multiply(weights[edgeBegin], values[edgeSource[edgeBegin]]));
+            if (op == MergeOp::NORM)
+                result = arithmetic.multiply(result, result);
+            for (std::uint32_t e = edgeBegin + 1; e < edgeEnd; ++e)
+            {
+                const Value x(arithmetic.multiply(weights[e], values[edgeSource[e]]));
+                switch (op)
+                {
+                    case MergeOp::SUM:
+                    case MergeOp::MEAN:
+                        result = arithmetic.add(result, x);
+                        break;
+                    case MergeOp::PRODUCT:
+                        result = arithmetic.multiply(result, x);
+                        break;
+                    case MergeOp::MIN:
+                        result = std::min(result, x);
+                        break;
+                    case MergeOp::MAX:
+                        result = std::max(result, x);
+                        break;
+                    case MergeOp::NORM:
+                        result = arithmetic.add(result, arithmetic.multiply(x, x));
+                        break;
+                }
+            }
+            if (op == MergeOp::MEAN)
+                result = arithmetic.divide(result, edgeEnd - edgeBegin);
+            else if (op == MergeOp::NORM)
+                result = arithmetic.sqrt(result);
+            return arithmetic.add(result, biases[k]);
+        }
+
+        // Calls the native function of EXTERN node n (see BehaviorExtern.h), unbound nodes yield zeros
+        void callExtern(const std::size_t n, Value* out)
+        {
+            const ExternBinding& binding(prog.externBindings[prog.nodePort[n]]);
+            const std::size_t numInputs(prog.nodeMergeBegin[n+1] - prog.nodeMergeBegin[n]);
+            const std::size_t numOutputs(prog.nodeSlotBegin[n+1] - prog.nodeSlotBegin[n]);
+            std::fill(externOut.begin(), externOut.end(), 0.0);
+            if (binding.function)
+            {
+                for (std::size_t i = 0; i < numInputs; ++i)
+                    externIn[i] = arithmetic.toReal(merged[prog.nodeMergeBegin[n] + i]);
+                const BehaviorExternCall call = {externIn.data(), 1, numInputs, externOut.data(), 1, numOutputs, 1};
+                binding.function(binding.context, &call);
+            }
+            for (std::size_t o = 0; o < numOutputs; ++o)
+                out[o] = arithmetic.fromReal(externOut[o]);
+        }
+
+        Program prog;
+        Backend arithmetic;
+        std::vector<std::uint32_t> sources[2];
+        std::vector<Value> weights;
+        std::vector<Value> biases;
+        std::vector<Value> defaults;
+        std::vector<Value> values;
+        std::vector<Value> merged;
+        std::vector<Value> inputs;
+        std::vector<double> externIn;
+        std::vector<double> externOut;
+        // Buffer written by the last step and its offset into values
+        std::size_t buffer;
+        std::size_t offset;
+        std::uint64_t numParameterSaturations;
+};
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef _BEHAVIOUR_OPTIMIZER_HPP
+#define _BEHAVIOUR_OPTIMIZER_HPP
+
+#include "BehaviorNetlist.hpp"
+#include "BehaviorFastMath.hpp"
+
+#include <ostream>
+
+namespace Behavior {
+
+// Summary of the changes made by optimize()
+struct OptimizerReport
+{
+    std::size_t zeroEdges;      // edges with a weight of zero
+    std::size_t foldedNodes;    // nodes replaced by their constant value
+    std::size_t deadNodes;      // nodes which can not reach any OUTPUT node
+    std::size_t pipes;          // PIPE nodes bypassed (see removePipes)
+    std::size_t duplicates;     // nodes computing the same as another node
+    std::vector<std::string> removedNodes;
+
+    std::size_t removed() const { return removedNodes.size(); }
+};
+
+std::ostream& operator<<(std::ostream& os, const OptimizerReport& report);
+
+/*
+    Simplifies a (flat) netlist without changing its outputs:
+
+    - Edges with a weight of zero are removed from SUM, NORM and PRODUCT merges (a PRODUCT then yields its bias).
+    - Nodes which only depend on constants are evaluated (with the given precision) and replaced by a PIPE without edges
+      which yields the result as the default of its merge. OUTPUT nodes are kept, only their merge becomes constant.
+    - Nodes which can not reach any OUTPUT node are removed (if there are OUTPUT nodes at all).
+    - Chains of PIPEs are bypassed (see removePipes).
+    - Nodes computing the same function of the same sources are merged.
+
+    The cycles are broken first (see breakCycles), so the delays stay where they are.
+    The passes are repeated until nothing changes. INPUT, OUTPUT and EXTERN nodes are never removed.
+    NOTE: All values are assumed to be finite (0 * x = 0) and the sign of zero is not preserved.
+*/
+OptimizerReport optimize(Netlist& netlist, const Precision precision = Precision::EXACT);
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef _BEHAVIOUR_PARALLEL_EVALUATOR_HPP
+#define _BEHAVIOUR_PARALLEL_EVALUATOR_HPP
+
+#include "BehaviorProgram.hpp"
+#include "BehaviorSimd.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace Behavior {
+
+/*
+    The ParallelEvaluator executes a compiled Program on several threads.
+
+    The nodes of one dependency level (see Program::levelBegin) are independent, so every level is split among the threads.
+    Each thread claims chunks of its own share and steals chunks from the others when it runs out of work.
+    A barrier separates the levels. Consecutive levels too small to be worth a barrier are evaluated by the calling thread alone.
+    The results are identical to the ones of the (serial) Evaluator with the same SimdLevel.
+    Double buffered programs (see Feedback) have less levels, because feedback edges do not constrain the order of their nodes.
+    EXTERN nodes are evaluated by whichever thread claims them, so their functions have to be reentrant (see BehaviorExtern.h).
+
+    The worker threads are started on construction and busy wait (spinning, then yielding, then sleeping) for the next step().
+    If requested, worker i is pinned to CPU i (the calling thread is left alone and acts as worker 0).
+*/
+class ParallelEvaluator
+{
+    public:
+        ParallelEvaluator(const Program& program,
+                          const std::size_t threads = std::thread::hardware_concurrency(),
+                          const bool pinThreads = false,
+                          const SimdLevel level = detectSimdLevel());
+        ~ParallelEvaluator();
+
+        // Sets all node outputs (of both buffers), merge results and inputs back to zero
+        void reset();
+
+        // Access to the INPUT and OUTPUT nodes (see Program::inputIndex and Program::outputIndex)
+        void setInput(const std::size_t idx, const double value) { inputs[idx] = value; }
+        double getOutput(const std::size_t idx) const { return values[offset + prog.outputSlots[idx]]; }
+
+        // Evaluates all nodes once (the calling thread takes part in the evaluation)
+        void step();
+
+        std::size_t threads() const { return numThreads; }
+        std::size_t phases() const { return phaseBegin.size(); }
+
+        const Program& program() const { return prog; }
+        // Node outputs of the last step (program.slots() values)
+        const double* slotValues() const { return values.data() + offset; }
+        const std::vector<double>& mergeValues() const { return merged; }
+
+    protected:
+        // The node range of one thread in the current phase (padded to a cache line to avoid false sharing)
+        struct Share
+        {
+            std::atomic<std::uint32_t> next;
+            std::uint32_t end;
+            char padding[64 - sizeof(std::atomic<std::uint32_t>) - sizeof(std::uint32_t)];
+        };
+
+        void work(const std::size_t id);
+        void runPhase(const std::size_t id, const std::size_t phase);
+        void claimNodes(Share& share);
+        void sync(bool& mySense, const std::size_t nextPhase);
+        void prepare(const std::size_t phase);
+
+        Program prog;
+        MergeKernel mergeKernel;
+        std::size_t numThreads;
+        std::vector<std::uint32_t> sources[2];
+        std::vector<double> values;
+        std::vector<double> merged;
+        std::vector<double> inputs;
+        // Buffer written by the current step and its offset into values
+        std::size_t buffer;
+        std::size_t offset;
+
+        // A phase is a range of nodes. A parallel phase is a single level, a serial phase one or more small levels.
+        std::vector<std::uint32_t> phaseBegin;
+        std::vector<std::uint32_t> phaseEnd;
+        std::vector<bool> phaseParallel;
+
+        std::vector<Share> shares;
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> arrived;
+        std::atomic<bool> released;
+        std::atomic<bool> stopping;
+        bool sense;
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef _BEHAVIOUR_PROFILER_HPP
+#define _BEHAVIOUR_PROFILER_HPP
+
+#include "BehaviorEvaluator.hpp"
+
+#include <string>
+
+namespace Behavior {
+
+/*
+    The ProfilingEvaluator executes a Program like the Evaluator, but records for every node how often it has been evaluated
+    and how long its merges and its operation took (in cycles of the time stamp counter, see profileUnit).
+    The Evaluator itself is not instrumented, so profiling costs nothing unless this class is used.
+    Nodes of inlined SUBGRAPHs are named <instance>/<node> (see inlineSubgraphs), so the profile can be summed up per instance.
+*/
+class ProfilingEvaluator : public Evaluator
+{
+    public:
+        ProfilingEvaluator(const Program& program, const SimdLevel level = detectSimdLevel());
+
+        // Evaluates all nodes once and measures every node
+        void step();
+
+        // Sets all counters back to zero (the values of the nodes are kept)
+        void resetProfile();
+
+        std::uint64_t steps() const { return numSteps; }
+        // Per node (in the order of the program)
+        const std::vector<std::uint64_t>& calls() const { return nodeCalls; }
+        const std::vector<std::uint64_t>& mergeTicks() const { return nodeMergeTicks; }
+        const std::vector<std::uint64_t>& nodeTicks() const { return nodeOpTicks; }
+        // Number of edges entering the merges of a node
+        std::size_t fanInOf(const std::size_t node) const;
+
+    protected:
+        std::uint64_t numSteps;
+        std::vector<std::uint64_t> nodeCalls;
+        std::vector<std::uint64_t> nodeMergeTicks;
+        std::vector<std::uint64_t> nodeOpTicks;
+};
+
+// The unit of the measured ticks ("cycles" where a time stamp counter exists, "ns" otherwise)
+const char* profileUnit();
+
+// Writes the profile as YAML: the totals per SUBGRAPH instance and every node (name, uid, operation, calls, ticks and fan-in),
+// both sorted by their ticks (the most expensive first)
+std::string profileToYAML(const ProfilingEvaluator& evaluator);
+
+// Writes the profile as folded stacks (one "<model>;<instance>;<node> <ticks>" line per node), as read by flame graph tools
+std::string profileToFoldedStacks(const ProfilingEvaluator& evaluator);
+
+}
+
+#endif
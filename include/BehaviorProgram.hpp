@@ -0,0 +1,122 @@
+#ifndef _BEHAVIOUR_PROGRAM_HPP
+#define _BEHAVIOUR_PROGRAM_HPP
+
+#include "BehaviorNetlist.hpp"
+#include "BehaviorFastMath.hpp"
+#include "BehaviorSymbols.hpp"
+#include "BehaviorExtern.hpp"
+
+namespace Behavior {
+
+// Evaluation of feedback edges (edges closing a cycle), which read the value of the previous step (one step delay)
+enum class Feedback : std::uint8_t
+{
+    IN_PLACE,       // one value buffer; the source of a feedback edge is evaluated after the nodes reading it (if possible)
+    DOUBLE_BUFFERED // two value buffers (ping-pong); every step writes one buffer, feedback edges read the other one
+};
+
+/*
+    A Program is a compiled Netlist: all nodes in evaluation order, stored as a struct of arrays.
+
+    Every node output owns one value slot.
+    The merges of node n are [nodeMergeBegin[n], nodeMergeBegin[n+1]),
+    the edges of merge m are [mergeEdgeBegin[m], mergeEdgeBegin[m+1]) and
+    the outputs of node n are the slots [nodeSlotBegin[n], nodeSlotBegin[n+1]).
+    Edges refer to their source by value slot, so evaluation needs no lookups at all.
+    Nodes are sorted by dependency level: the nodes [levelBegin[l], levelBegin[l+1]) do not depend on each other.
+
+    Cycles are broken by delayed edges (edgeDelayed, see breakCycles).
+    If the delayed edges of a netlist can not be evaluated in place, the program is double buffered.
+    With double buffering, feedback edges do not constrain the order of the nodes and every step only swaps the buffers.
+    The value array then holds both buffers [even steps | odd steps] and the edges of a step use sourcesOf(buffer) instead of edgeSource.
+
+    Names and uids are Symbols of the program's own table, symbols.str(program.nodeNames[n]) is the name of node n.
+    The port of an INPUT, OUTPUT or EXTERN node is its index into the inputs, outputs or externs respectively.
+    EXTERN nodes call the native function bound to their extern name (see bindExterns), their outputs are all their slots.
+*/
+class Program
+{
+    public:
+        static const std::size_t npos;
+
+        Program();
+        Program(const Netlist& netlist, const Precision precision = Precision::EXACT, const Feedback feedback = Feedback::IN_PLACE);
+
+        bool empty() const { return nodeOps.empty(); }
+        std::size_t nodes() const { return nodeOps.size(); }
+        std::size_t merges() const { return mergeOps.size(); }
+        std::size_t edges() const { return edgeSource.size(); }
+        std::size_t slots() const { return nodeSlotBegin.empty() ? 0 : nodeSlotBegin.back(); }
+        std::size_t levels() const { return levelBegin.empty() ? 0 : levelBegin.size() - 1; }
+        std::size_t buffers() const { return feedback == Feedback::DOUBLE_BUFFERED ? 2 : 1; }
+
+        // Edge sources (indices into all buffers) of a step writing the given buffer
+        std::vector<std::uint32_t> sourcesOf(const std::size_t buffer) const;
+
+        // External interface given by the INPUT and OUTPUT nodes
+        std::size_t inputIndex(const std::string& name) const;
+        std::size_t outputIndex(const std::string& name) const;
+
+        // Dependency level of a node and the node owning a merge
+        std::size_t levelOf(const std::size_t node) const;
+        std::size_t nodeOf(const std::size_t merge) const;
+
+        // Nodes needed to compute the given outputs (see outputIndex): their backward cone, including the sources of feedback edges
+        // NOTE: EXTERN nodes (and their cones) are always needed, as their functions may have side effects
+        std::vector<bool> demandOf(const std::vector<std::size_t>& outputs) const;
+
+        // Appends an edge to merge k or removes edge e (all later merges and edges move accordingly)
+        // NOTE: The caller has to make sure that the order and the levels of the nodes stay valid (see Evaluator::update)
+        void insertEdge(const std::size_t merge, const std::uint32_t source, const double weight, const bool delayed, const UniqueId& uid);
+        void removeEdge(const std::size_t edge);
+
+        std::string name;
+
+        // Accuracy of the node functions (see BehaviorFastMath.hpp)
+        Precision precision;
+        Feedback feedback;
+
+        // Nodes (in evaluation order)
+        std::vector<NodeOp> nodeOps;
+        std::vector<std::uint32_t> nodeMergeBegin;
+        std::vector<std::uint32_t> nodeSlotBegin;
+        std::vector<std::uint32_t> nodePort;
+        std::vector<std::uint32_t> levelBegin;
+
+        // Merges
+        std::vector<MergeOp> mergeOps;
+        std::vector<double> mergeBias;
+        std::vector<double> mergeDefault;
+        std::vector<std::uint32_t> mergeEdgeBegin;
+
+        // Edges
+        std::vector<std::uint32_t> edgeSource;
+        std::vector<double> edgeWeight;
+        std::vector<std::uint8_t> edgeDelayed;
+
+        // Interface
+        Symbols inputNames;
+        Symbols outputNames;
+        std::vector<std::uint32_t> outputSlots;
+
+        // EXTERN nodes
+        Symbols externNames;
+        std::vector<ExternBinding> externBindings;
+
+        // Origin of every entity in the hypergraph
+        Symbols nodeNames;
+        Symbols nodeUids;
+        Symbols mergeUids;
+        Symbols edgeUids;
+
+        // All names and uids (each stored once, e.g. the uids shared by the instances of a SUBGRAPH)
+        SymbolTable symbols;
+};
+
+// Recovers the netlist of a program (nodes in evaluation order, delays kept)
+// NOTE: The interfaces of the nodes are named by their index
+Netlist netlistOf(const Program& program);
+
+}
+
+#endif
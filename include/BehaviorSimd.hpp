@@ -0,0 +1,39 @@
+#ifndef _BEHAVIOUR_SIMD_HPP
+#define _BEHAVIOUR_SIMD_HPP
+
+#include "BehaviorNetlist.hpp"
+
+namespace Behavior {
+
+// Instruction set extensions used by the vectorized kernels
+enum class SimdLevel : std::uint8_t
+{
+    SCALAR,
+    AVX2,
+    AVX512
+};
+
+// Returns the best instruction set extension supported by the running CPU
+SimdLevel detectSimdLevel();
+
+// A merge kernel fuses the edge weights into the merge operation (same semantics as applyMerge)
+typedef double (*MergeKernel)(const MergeOp op, const double bias, const double defaultValue,
+                              const std::uint32_t* sources, const double* weights, const std::size_t n,
+                              const double* values);
+
+// Returns the merge kernel for the given instruction set extension
+MergeKernel mergeKernelFor(const SimdLevel level);
+
+// Below this fan-in the plain scalar kernel is faster than a vectorized one
+static const std::size_t SimdMergeThreshold = 8;
+
+// A dense kernel computes y[r] = bias[r] + sum_c weights[r * columns + c] * x[c] for all rows (SUM merges of a dense layer)
+typedef void (*DenseKernel)(const double* weights, const std::size_t rows, const std::size_t columns,
+                            const double* x, const double* bias, double* y);
+
+// Returns the dense kernel for the given instruction set extension
+DenseKernel denseKernelFor(const SimdLevel level);
+
+}
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef _BEHAVIOUR_STATIC_HPP
+#define _BEHAVIOUR_STATIC_HPP
+
+#include "BehaviorNetlist.hpp"
+#include "BehaviorFastMath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace Behavior {
+
+/*
+    Compile-time evaluation of graphs with a fixed topology (header only).
+
+    Every node, merge, edge and constant is a type, a graph is a list of node types.
+    Graph::step() is instantiated for exactly this list, so evaluation is fully unrolled without any dispatch
+    and the compiler sees all weights. The results equal those of an Evaluator with SimdLevel::SCALAR,
+    as long as the compiler does not contract multiplications and additions (see -ffp-contract=off).
+
+    Such a graph is usually generated from a Program by generateStaticCpp() (see BehaviorCodegen.hpp),
+    but it can be written down by hand as well:
+
+        typedef Static::Graph<Precision::EXACT, 1, 3, 1, Static::Outputs<2>,
+            Static::Input<0, 0>,
+            Static::Node<NodeOp::SIN, 1, Static::Merge<MergeOp::SUM, Static::Constant<0, 0>, Static::Constant<0, 0>,
+                                                       Static::Edge<0, Static::Constant<1, 1>>>>,
+            Static::Node<NodeOp::OUTPUT, 2, Static::Merge<MergeOp::SUM, Static::Constant<0, 0>, Static::Constant<0, 0>,
+                                                          Static::Edge<1, Static::Constant<1, 0>>>>
+        > Model; // out = sin(2 * in)
+*/
+namespace Static {
+
+constexpr double square(const double x)
+{
+    return x * x;
+}
+
+// 2^e (exact for normal results)
+constexpr double pow2(const int e)
+{
+    return e == 0 ? 1.0 : (e % 2 ? (e > 0 ? 2.0 : 0.5) : 1.0) * square(pow2(e / 2));
+}
+
+// The constant Mantissa * 2^Exponent (every finite double can be written this way)
+template<std::int64_t Mantissa, int Exponent> struct Constant
+{
+    static constexpr double value = Mantissa * pow2(Exponent);
+};
+
+// An edge reading the output slot 'Source' (of the previous step if 'Delayed' and the graph is double buffered)
+template<std::uint32_t Source, typename Weight, bool Delayed = false> struct Edge
+{
+    static double value(const double* v, const double* p)
+    {
+        return Weight::value * (Delayed ? p : v)[Source];
+    }
+};
+
+// Accumulation of one more edge (the first edge initializes the accumulator)
+template<MergeOp Op> struct Combine;
+template<> struct Combine<MergeOp::SUM> { static double apply(const double a, const double x) { return a + x; } };
+template<> struct Combine<MergeOp::MEAN> { static double apply(const double a, const double x) { return a + x; } };
+template<> struct Combine<MergeOp::PRODUCT> { static double apply(const double a, const double x) { return a * x; } };
+template<> struct Combine<MergeOp::MIN> { static double apply(const double a, const double x) { return std::min(a, x); } };
+template<> struct Combine<MergeOp::MAX> { static double apply(const double a, const double x) { return std::max(a, x); } };
+template<> struct Combine<MergeOp::NORM> { static double apply(const double a, const double x) { return a + x * x; } };
+
+// A merge computing 'Bias + Op(edges)' or 'Default' if it has no edges
+template<MergeOp Op, typename Bias, typename Default, typename... Edges> struct Merge;
+
+template<MergeOp Op, typename Bias, typename Default> struct Merge<Op, Bias, Default>
+{
+    static double value(const double*, const double*)
+    {
+        return Default::value;
+    }
+};
+
+template<MergeOp Op, typename Bias, typename Default, typename First, typename... Rest> struct Merge<Op, Bias, Default, First, Rest...>
+{
+    static double value(const double* v, const double* p)
+    {
+        double result(First::value(v, p));
+        if (Op == MergeOp::NORM)
+            result *= result;
+        // Braced initializers are evaluated in order, so this is a left fold
+        const int expand[] = {0, (result = Combine<Op>::apply(result, Rest::value(v, p)), 0)...};
+        (void)expand;
+        if (Op == MergeOp::MEAN)
+            result /= 1 + sizeof...(Rest);
+        if (Op == MergeOp::NORM)
+            result = std::sqrt(result);
+        return result + Bias::value;
+    }
+};
+
+// The functions of the built-in nodes
+template<NodeOp Op> struct Function;
+template<> struct Function<NodeOp::PIPE> { template<Precision P> static double apply(const double* in) { return in[0]; } };
+template<> struct Function<NodeOp::OUTPUT> { template<Precision P> static double apply(const double* in) { return in[0]; } };
+template<> struct Function<NodeOp::DIVIDE> { template<Precision P> static double apply(const double* in) { return 1.0 / in[0]; } };
+template<> struct Function<NodeOp::SIN> { template<Precision P> static double apply(const double* in) { return FastMath::sin<P>(in[0]); } };
+template<> struct Function<NodeOp::COS> { template<Precision P> static double apply(const double* in) { return FastMath::cos<P>(in[0]); } };
+template<> struct Function<NodeOp::TAN> { template<Precision P> static double apply(const double* in) { return std::tan(in[0]); } };
+template<> struct Function<NodeOp::TANH> { template<Precision P> static double apply(const double* in) { return FastMath::tanh<P>(in[0]); } };
+template<> struct Function<NodeOp::ACOS> { template<Precision P> static double apply(const double* in) { return std::acos(in[0]); } };
+template<> struct Function<NodeOp::ASIN> { template<Precision P> static double apply(const double* in) { return std::asin(in[0]); } };
+template<> struct Function<NodeOp::ATAN> { template<Precision P> static double apply(const double* in) { return FastMath::atan<P>(in[0]); } };
+template<> struct Function<NodeOp::LOG> { template<Precision P> static double apply(const double* in) { return FastMath::log<P>(in[0]); } };
+template<> struct Function<NodeOp::EXP> { template<Precision P> static double apply(const double* in) { return FastMath::exp<P>(in[0]); } };
+template<> struct Function<NodeOp::ABS> { template<Precision P> static double apply(const double* in) { return std::fabs(in[0]); } };
+template<> struct Function<NodeOp::SQRT> { template<Precision P> static double apply(const double* in) { return std::sqrt(in[0]); } };
+template<> struct Function<NodeOp::ATAN2> { template<Precision P> static double apply(const double* in) { return FastMath::atan2<P>(in[0], in[1]); } };
+template<> struct Function<NodeOp::POW> { template<Precision P> static double apply(const double* in) { return FastMath::pow<P>(in[0], in[1]); } };
+template<> struct Function<NodeOp::MOD> { template<Precision P> static double apply(const double* in) { return std::fmod(in[0], in[1]); } };
+template<> struct Function<NodeOp::GREATER_ZERO> { template<Precision P> static double apply(const double* in) { return in[0] > 0.0 ? in[1] : in[2]; } };
+template<> struct Function<NodeOp::APPROX_ZERO> { template<Precision P> static double apply(const double* in) { return std::fabs(in[0]) < ApproxZeroEpsilon ? in[1] : in[2]; } };
+
+// A node reading the input 'Port' into 'Slot'
+template<std::uint32_t Slot, std::uint32_t Port> struct Input
+{
+    template<Precision P> static void evaluate(double* v, const double*, const double* in)
+    {
+        v[Slot] = in[Port];
+    }
+};
+
+// A built-in node writing 'Op(merges)' into 'Slot'
+template<NodeOp Op, std::uint32_t Slot, typename... Merges> struct Node
+{
+    template<Precision P> static void evaluate(double* v, const double* p, const double*)
+    {
+        const double m[] = {Merges::value(v, p)...};
+        v[Slot] = Function<Op>::template apply<P>(m);
+    }
+};
+
+// The slots of the OUTPUT nodes
+template<std::uint32_t... Slots> struct Outputs {};
+
+/*
+    A graph of 'Slots' values evaluating its nodes in the given order.
+    With two 'Buffers' every step writes the other buffer and delayed edges read the previous one (see Feedback).
+*/
+template<Precision P, std::size_t Inputs, std::size_t Slots, std::size_t Buffers, typename OutputSlots, typename... Nodes> struct Graph;
+
+template<Precision P, std::size_t Inputs, std::size_t Slots, std::size_t Buffers, std::uint32_t... OutputSlots, typename... Nodes>
+struct Graph<P, Inputs, Slots, Buffers, Outputs<OutputSlots...>, Nodes...>
+{
+    static constexpr std::size_t inputs = Inputs;
+    static constexpr std::size_t outputs = sizeof...(OutputSlots);
+    static constexpr std::size_t slots = Slots;
+    static constexpr std::size_t buffers = Buffers;
+
+    struct State
+    {
+        double values[Slots * Buffers > 0 ? Slots * Buffers : 1];
+        std::size_t buffer;
+    };
+
+    static void reset(State& state)
+    {
+        for (std::size_t i = 0; i < Slots * Buffers; ++i)
+            state.values[i] = 0.0;
+        state.buffer = 0;
+    }
+
+    // Evaluates all nodes once: Reads in[inputs] and writes out[outputs]
+    static void step(State& state, const double* in, double* out)
+    {
+        state.buffer = (state.buffer + 1) % Buffers;
+        double* const v(state.values + state.buffer * Slots);
+        const double* const p(state.values + (Buffers - 1 - state.buffer) * Slots);
+        const int expand[] = {0, (Nodes::template evaluate<P>(v, p, in), 0)...};
+        (void)expand;
+        (void)p;
+        (void)in;
+        const double result[] = {0.0, v[OutputSlots]...};
+        for (std::size_t o = 0; o < outputs; ++o)
+            out[o] = result[o + 1];
+    }
+};
+
+}
+
+}
+
+#endif
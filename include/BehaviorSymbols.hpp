@@ -0,0 +1,59 @@
+#ifndef _BEHAVIOUR_SYMBOLS_HPP
+#define _BEHAVIOUR_SYMBOLS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Behavior {
+
+// Dense handle of an interned string (see SymbolTable)
+typedef std::uint32_t Symbol;
+typedef std::vector<Symbol> Symbols;
+
+/*
+    A SymbolTable stores every distinct string once and hands out consecutive Symbols (0, 1, 2, ...).
+    The strings are kept NUL-terminated in one buffer, so interning costs no allocation per string.
+    Comparing or hashing symbols is an integer operation, only intern() and find() hash the text.
+    NOTE: Symbols of different tables must not be mixed
+*/
+class SymbolTable
+{
+    public:
+        static const Symbol npos;
+
+        SymbolTable();
+
+        // Returns the symbol of a string (creating it if it does not exist yet)
+        Symbol intern(const std::string& text);
+        Symbol intern(const char* text, const std::size_t length);
+        // Returns the symbol of a string or npos if it has not been interned
+        Symbol find(const std::string& text) const;
+
+        const char* str(const Symbol symbol) const { return chars.data() + offsets[symbol]; }
+        std::size_t lengthOf(const Symbol symbol) const;
+        std::size_t size() const { return offsets.size(); }
+        // Heap memory held by the table
+        std::size_t bytes() const;
+        // Releases the memory reserved for more strings
+        void shrink();
+
+        // All strings in the order of their symbols, each followed by NUL
+        const std::string& data() const { return chars; }
+        // Position of a string in data()
+        std::uint32_t offsetOf(const Symbol symbol) const { return offsets[symbol]; }
+
+    private:
+        Symbol find(const char* text, const std::size_t length, const std::uint32_t hash, std::size_t& bucket) const;
+        void grow();
+
+        std::string chars;
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> hashes;
+        // Open addressing (linear probing), every bucket holds a symbol + 1 or 0 if empty
+        std::vector<std::uint32_t> buckets;
+};
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef _BEHAVIOUR_UPDATE_HPP
+#define _BEHAVIOUR_UPDATE_HPP
+
+#include "Hypergraph.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace Behavior {
+
+/*
+    A change of a model which is applied to the hypergraph (Graph::update) and to compiled programs (Evaluator::update)
+    without importing or compiling the model again. Entities are identified by their uids, which compiled programs keep.
+    Applying the same updates to both keeps them in sync:
+
+        Behavior::Updates updates{Behavior::Update::weight(edgeUid, 0.5), Behavior::Update::addEdge(mergeUid, nodeUid, 0, 1.0)};
+        bg.update(updates);   // creates the new edge and stores its uid in the update
+        eval.update(updates);
+*/
+struct Update
+{
+    enum class Kind : std::uint8_t
+    {
+        WEIGHT,     // sets the weight of EDGE 'uid' to 'value'
+        BIAS,       // sets the bias of MERGE 'uid' to 'value'
+        DEFAULT,    // sets the default value of MERGE 'uid' to 'value'
+        ADD_EDGE,   // connects output 'output' of NODE 'source' to MERGE 'uid' by a new EDGE 'edge' of weight 'value'
+        REMOVE_EDGE // removes EDGE 'uid'
+    };
+
+    Kind kind;
+    UniqueId uid;
+    double value;
+    UniqueId source;
+    std::size_t output;
+    UniqueId edge;
+
+    static Update weight(const UniqueId& edgeUid, const double weight) { return Update{Kind::WEIGHT, edgeUid, weight, "", 0, ""}; }
+    static Update bias(const UniqueId& mergeUid, const double bias) { return Update{Kind::BIAS, mergeUid, bias, "", 0, ""}; }
+    static Update defaultValue(const UniqueId& mergeUid, const double value) { return Update{Kind::DEFAULT, mergeUid, value, "", 0, ""}; }
+    static Update addEdge(const UniqueId& mergeUid, const UniqueId& sourceUid, const std::size_t output, const double weight)
+    {
+        return Update{Kind::ADD_EDGE, mergeUid, weight, sourceUid, output, ""};
+    }
+    static Update removeEdge(const UniqueId& edgeUid) { return Update{Kind::REMOVE_EDGE, edgeUid, 0.0, "", 0, ""}; }
+};
+
+typedef std::vector<Update> Updates;
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+#include "BehaviorBatchEvaluator.hpp"
+#include "BehaviorKernels.hpp"
+
+#include <algorithm>
+
+namespace Behavior {
+
+BatchEvaluator::BatchEvaluator(const Program& program, const std::size_t lanes)
+: prog(program),
+  numLanes(lanes),
+  values(program.slots() * program.buffers() * lanes, 0.0),
+  merged(program.merges() * lanes, 0.0),
+  inputs(program.inputNames.size() * lanes, 0.0),
+  buffer(0),
+  offset(0)
+{
+    for (std::size_t b = 0; b < prog.buffers(); ++b)
+        sources[b] = prog.sourcesOf(b);
+}
+
+BatchEvaluator::~BatchEvaluator()
+{
+}
+
+void BatchEvaluator::reset()
+{
+    std::fill(values.begin(), values.end(), 0.0);
+    std::fill(merged.begin(), merged.end(), 0.0);
+    std::fill(inputs.begin(), inputs.end(), 0.0);
+    buffer = 0;
+    offset = 0;
+}
+
+void BatchEvaluator::step()
+{
+    // Every step writes the buffer read by the next one
+    buffer = (buffer + 1) % prog.buffers();
+    offset = buffer * prog.slots();
+
+    const std::size_t nodes(prog.nodes());
+    const std::uint32_t* edgeSource(sources[buffer].data());
+    const double* edgeWeight(prog.edgeWeight.data());
+    double* v(values.data());
+    double* m(merged.data());
+
+    for (std::size_t n = 0; n < nodes; ++n)
+    {
+        const std::uint32_t mergeBegin(prog.nodeMergeBegin[n]);
+        const std::uint32_t mergeEnd(prog.nodeMergeBegin[n+1]);
+        for (std::uint32_t k = mergeBegin; k < mergeEnd; ++k)
+        {
+            const std::uint32_t edgeBegin(prog.mergeEdgeBegin[k]);
+            applyMergeBatch(prog.mergeOps[k], prog.mergeBias[k], prog.mergeDefault[k],
+                            edgeSource + edgeBegin, edgeWeight + edgeBegin, prog.mergeEdgeBegin[k+1] - edgeBegin,
+                            v, numLanes, numLanes, m + k * numLanes);
+        }
+
+        const NodeOp op(prog.nodeOps[n]);
+        double* out(v + (offset + prog.nodeSlotBegin[n]) * numLanes);
+        if (op == NodeOp::INPUT)
+            std::copy(inputs.begin() + prog.nodePort[n] * numLanes, inputs.begin() + (prog.nodePort[n] + 1) * numLanes, out);
+        else if (op == NodeOp::EXTERN)
+            applyExtern(prog, n, m + mergeBegin * numLanes, numLanes, out, numLanes, numLanes);
+        else
+            applyNodeBatch(op, m + mergeBegin * numLanes, numLanes, out, prog.precision);
+    }
+}
+
+}
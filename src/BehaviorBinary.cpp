@@ -0,0 +1,317 @@
+#include "BehaviorBinary.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Behavior {
+
+// Sizes of the sections in the order they are stored (all padded to multiples of 8)
+static std::vector<std::size_t> sectionSizesOf(const Binary::Header& header)
+{
+    return std::vector<std::size_t>{
+        header.nodes * sizeof(Binary::Node),
+        header.merges * sizeof(Binary::Merge),
+        header.edges * sizeof(Binary::Edge),
+        header.merges * sizeof(double),
+        header.merges * sizeof(double),
+        header.edges * sizeof(double),
+        header.levels * sizeof(std::uint32_t),
+        header.inputs * sizeof(std::uint32_t),
+        header.outputs * sizeof(std::uint32_t),
+        header.outputs * sizeof(std::uint32_t),
+        header.externs * sizeof(std::uint32_t),
+        header.strings
+    };
+}
+
+static std::size_t paddedSizeOf(const std::size_t size)
+{
+    return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+std::string serializeProgram(const Program& program)
+{
+    // The strings of the program with its name
+    SymbolTable strings(program.symbols);
+    Binary::Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = Binary::Magic;
+    header.version = Binary::Version;
+    header.precision = static_cast<std::uint8_t>(program.precision);
+    header.feedback = static_cast<std::uint8_t>(program.feedback);
+    header.name = strings.offsetOf(strings.intern(program.name));
+    header.nodes = program.nodes();
+    header.merges = program.merges();
+    header.edges = program.edges();
+    header.slots = program.slots();
+    header.levels = program.levelBegin.size();
+    header.inputs = program.inputNames.size();
+    header.outputs = program.outputNames.size();
+    header.externs = program.externNames.size();
+
+    std::vector<Binary::Node> nodes(program.nodes());
+    std::memset(nodes.data(), 0, nodes.size() * sizeof(Binary::Node));
+    for (std::size_t n = 0; n < nodes.size(); ++n)
+    {
+        nodes[n].op = static_cast<std::uint8_t>(program.nodeOps[n]);
+        nodes[n].mergeBegin = program.nodeMergeBegin[n];
+        nodes[n].slotBegin = program.nodeSlotBegin[n];
+        nodes[n].port = program.nodePort[n];
+        nodes[n].name = strings.offsetOf(program.nodeNames[n]);
+        nodes[n].uid = strings.offsetOf(program.nodeUids[n]);
+    }
+    std::vector<Binary::Merge> merges(program.merges());
+    std::memset(merges.data(), 0, merges.size() * sizeof(Binary::Merge));
+    for (std::size_t k = 0; k < merges.size(); ++k)
+    {
+        merges[k].op = static_cast<std::uint8_t>(program.mergeOps[k]);
+        merges[k].edgeBegin = program.mergeEdgeBegin[k];
+        merges[k].uid = strings.offsetOf(program.mergeUids[k]);
+    }
+    std::vector<Binary::Edge> edges(program.edges());
+    std::memset(edges.data(), 0, edges.size() * sizeof(Binary::Edge));
+    for (std::size_t e = 0; e < edges.size(); ++e)
+    {
+        edges[e].source = program.edgeSource[e];
+        edges[e].delayed = program.edgeDelayed[e];
+        edges[e].uid = strings.offsetOf(program.edgeUids[e]);
+    }
+    std::vector<std::uint32_t> inputNames, outputNames, externNames;
+    for (const Symbol inputName : program.inputNames)
+        inputNames.push_back(strings.offsetOf(inputName));
+    for (const Symbol outputName : program.outputNames)
+        outputNames.push_back(strings.offsetOf(outputName));
+    for (const Symbol externName : program.externNames)
+        externNames.push_back(strings.offsetOf(externName));
+    header.strings = strings.data().size();
+
+    const void* sections[] = {nodes.data(), merges.data(), edges.data(),
+                              program.mergeBias.data(), program.mergeDefault.data(), program.edgeWeight.data(),
+                              program.levelBegin.data(), inputNames.data(), outputNames.data(), program.outputSlots.data(),
+                              externNames.data(), strings.data().data()};
+    const std::vector<std::size_t> sizes(sectionSizesOf(header));
+    std::string result(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (std::size_t i = 0; i < sizes.size(); ++i)
+    {
+        result.append(static_cast<const char*>(sections[i]), sizes[i]);
+        result.append(paddedSizeOf(sizes[i]) - sizes[i], '\0');
+    }
+    return result;
+}
+
+// Checks that the begin indices never decrease and stay within [0, end]
+template<typename Record> static bool isMonotonic(const Record* records, const std::size_t n, std::uint32_t Record::*begin, const std::size_t end)
+{
+    std::uint32_t last(0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if ((records[i].*begin < last) || (records[i].*begin > end))
+            return false;
+        last = records[i].*begin;
+    }
+    return true;
+}
+
+// Tells whether an offset is the start of a string of the table (see deserializeProgram)
+static bool isString(const std::vector<Symbol>& symbolAt, const std::uint32_t offset)
+{
+    return (offset < symbolAt.size()) && (symbolAt[offset] != SymbolTable::npos);
+}
+
+Program deserializeProgram(const char* data, const std::size_t size)
+{
+    Binary::Header header;
+    if (size < sizeof(header))
+        return Program();
+    std::memcpy(&header, data, sizeof(header));
+    if ((header.magic != Binary::Magic) || (header.version != Binary::Version))
+        return Program();
+    if ((header.precision > static_cast<std::uint8_t>(Precision::LOW)) || (header.feedback > static_cast<std::uint8_t>(Feedback::DOUBLE_BUFFERED)))
+        return Program();
+
+    // Locate the sections
+    const std::vector<std::size_t> sizes(sectionSizesOf(header));
+    std::vector<std::size_t> offsets;
+    std::size_t offset(sizeof(header));
+    for (const std::size_t sectionSize : sizes)
+    {
+        offsets.push_back(offset);
+        offset += paddedSizeOf(sectionSize);
+    }
+    if (offset > size)
+        return Program();
+    std::vector<const char*> sections;
+    for (const std::size_t sectionOffset : offsets)
+        sections.push_back(data + sectionOffset);
+    const Binary::Node* nodes(reinterpret_cast<const Binary::Node*>(sections[0]));
+    const Binary::Merge* merges(reinterpret_cast<const Binary::Merge*>(sections[1]));
+    const Binary::Edge* edges(reinterpret_cast<const Binary::Edge*>(sections[2]));
+    const std::uint32_t* levelBegin(reinterpret_cast<const std::uint32_t*>(sections[6]));
+    const std::uint32_t* inputNames(reinterpret_cast<const std::uint32_t*>(sections[7]));
+    const std::uint32_t* outputNames(reinterpret_cast<const std::uint32_t*>(sections[8]));
+    const std::uint32_t* outputSlots(reinterpret_cast<const std::uint32_t*>(sections[9]));
+    const std::uint32_t* externNames(reinterpret_cast<const std::uint32_t*>(sections[10]));
+    const char* strings(sections[11]);
+
+    // Intern all strings (references have to point to the start of a string)
+    if (!header.strings || strings[header.strings - 1])
+        return Program();
+    Program program;
+    std::vector<Symbol> symbolAt(header.strings, SymbolTable::npos);
+    for (std::size_t start = 0; start < header.strings; start += program.symbols.lengthOf(symbolAt[start]) + 1)
+        symbolAt[start] = program.symbols.intern(strings + start, std::strlen(strings + start));
+
+    // Validate everything an evaluator relies on
+    if (!isString(symbolAt, header.name))
+        return Program();
+    if (!isMonotonic(nodes, header.nodes, &Binary::Node::mergeBegin, header.merges) ||
+        !isMonotonic(nodes, header.nodes, &Binary::Node::slotBegin, header.slots) ||
+        !isMonotonic(merges, header.merges, &Binary::Merge::edgeBegin, header.edges))
+        return Program();
+    for (std::size_t n = 0; n < header.nodes; ++n)
+    {
+        // Programs are flat, so there are no SUBGRAPH nodes to evaluate
+        if ((nodes[n].op >= static_cast<std::uint8_t>(NodeOp::SUBGRAPH)) || !isString(symbolAt, nodes[n].name) || !isString(symbolAt, nodes[n].uid))
+            return Program();
+        // All nodes but EXTERN ones write exactly one slot and read (at least) one merge per input
+        const NodeOp op(static_cast<NodeOp>(nodes[n].op));
+        const std::size_t mergeEnd(n + 1 < header.nodes ? nodes[n+1].mergeBegin : header.merges);
+        const std::size_t slotEnd(n + 1 < header.nodes ? nodes[n+1].slotBegin : header.slots);
+        if ((op != NodeOp::EXTERN) && ((slotEnd - nodes[n].slotBegin != 1) || (mergeEnd - nodes[n].mergeBegin < arityOf(op))))
+            return Program();
+        if ((nodes[n].op == static_cast<std::uint8_t>(NodeOp::INPUT)) && (nodes[n].port >= header.inputs))
+            return Program();
+        if ((nodes[n].op == static_cast<std::uint8_t>(NodeOp::OUTPUT)) && (nodes[n].port >= header.outputs))
+            return Program();
+        if ((nodes[n].op == static_cast<std::uint8_t>(NodeOp::EXTERN)) && (nodes[n].port >= header.externs))
+            return Program();
+    }
+    for (std::size_t k = 0; k < header.merges; ++k)
+    {
+        if ((merges[k].op > static_cast<std::uint8_t>(MergeOp::NORM)) || !isString(symbolAt, merges[k].uid))
+            return Program();
+    }
+    for (std::size_t e = 0; e < header.edges; ++e)
+    {
+        if ((edges[e].source >= header.slots) || !isString(symbolAt, edges[e].uid))
+            return Program();
+    }
+    // The levels partition all nodes
+    if (!header.levels || levelBegin[0] || (levelBegin[header.levels-1] != header.nodes))
+        return Program();
+    for (std::size_t l = 0; l < header.levels; ++l)
+    {
+        if ((levelBegin[l] > header.nodes) || (l && (levelBegin[l] < levelBegin[l-1])))
+            return Program();
+    }
+    for (std::size_t i = 0; i < header.inputs; ++i)
+    {
+        if (!isString(symbolAt, inputNames[i]))
+            return Program();
+    }
+    for (std::size_t o = 0; o < header.outputs; ++o)
+    {
+        if (!isString(symbolAt, outputNames[o]) || (outputSlots[o] >= header.slots))
+            return Program();
+    }
+    for (std::size_t x = 0; x < header.externs; ++x)
+    {
+        if (!isString(symbolAt, externNames[x]))
+            return Program();
+    }
+
+    // Copy the sections
+    program.name = strings + header.name;
+    program.precision = static_cast<Precision>(header.precision);
+    program.feedback = static_cast<Feedback>(header.feedback);
+    program.nodeOps.resize(header.nodes);
+    program.nodeMergeBegin.resize(header.nodes + 1);
+    program.nodeSlotBegin.resize(header.nodes + 1);
+    program.nodePort.resize(header.nodes);
+    program.nodeNames.resize(header.nodes);
+    program.nodeUids.resize(header.nodes);
+    for (std::size_t n = 0; n < header.nodes; ++n)
+    {
+        program.nodeOps[n] = static_cast<NodeOp>(nodes[n].op);
+        program.nodeMergeBegin[n] = nodes[n].mergeBegin;
+        program.nodeSlotBegin[n] = nodes[n].slotBegin;
+        program.nodePort[n] = nodes[n].port;
+        program.nodeNames[n] = symbolAt[nodes[n].name];
+        program.nodeUids[n] = symbolAt[nodes[n].uid];
+    }
+    program.nodeMergeBegin[header.nodes] = header.merges;
+    program.nodeSlotBegin[header.nodes] = header.slots;
+    program.levelBegin.assign(levelBegin, levelBegin + header.levels);
+
+    program.mergeOps.resize(header.merges);
+    program.mergeEdgeBegin.resize(header.merges + 1);
+    program.mergeUids.resize(header.merges);
+    for (std::size_t k = 0; k < header.merges; ++k)
+    {
+        program.mergeOps[k] = static_cast<MergeOp>(merges[k].op);
+        program.mergeEdgeBegin[k] = merges[k].edgeBegin;
+        program.mergeUids[k] = symbolAt[merges[k].uid];
+    }
+    program.mergeEdgeBegin[header.merges] = header.edges;
+    program.mergeBias.assign(reinterpret_cast<const double*>(sections[3]), reinterpret_cast<const double*>(sections[3]) + header.merges);
+    program.mergeDefault.assign(reinterpret_cast<const double*>(sections[4]), reinterpret_cast<const double*>(sections[4]) + header.merges);
+
+    program.edgeSource.resize(header.edges);
+    program.edgeDelayed.resize(header.edges);
+    program.edgeUids.resize(header.edges);
+    for (std::size_t e = 0; e < header.edges; ++e)
+    {
+        program.edgeSource[e] = edges[e].source;
+        program.edgeDelayed[e] = edges[e].delayed;
+        program.edgeUids[e] = symbolAt[edges[e].uid];
+    }
+    program.edgeWeight.assign(reinterpret_cast<const double*>(sections[5]), reinterpret_cast<const double*>(sections[5]) + header.edges);
+
+    for (std::size_t i = 0; i < header.inputs; ++i)
+        program.inputNames.push_back(symbolAt[inputNames[i]]);
+    for (std::size_t o = 0; o < header.outputs; ++o)
+        program.outputNames.push_back(symbolAt[outputNames[o]]);
+    program.outputSlots.assign(outputSlots, outputSlots + header.outputs);
+    for (std::size_t x = 0; x < header.externs; ++x)
+        program.externNames.push_back(symbolAt[externNames[x]]);
+    program.externBindings.assign(header.externs, ExternBinding{NULL, NULL});
+    program.symbols.shrink();
+    return program;
+}
+
+bool saveProgram(const Program& program, const std::string& fileName)
+{
+    std::ofstream fout(fileName, std::ios::binary);
+    if (!fout.good())
+        return false;
+    const std::string data(serializeProgram(program));
+    fout.write(data.data(), data.size());
+    return fout.good();
+}
+
+Program loadProgram(const std::string& fileName)
+{
+    const int fd(open(fileName.c_str(), O_RDONLY));
+    if (fd < 0)
+        return Program();
+    struct stat info;
+    if ((fstat(fd, &info) < 0) || (info.st_size <= 0))
+    {
+        close(fd);
+        return Program();
+    }
+    const std::size_t size(info.st_size);
+    void* data(mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0));
+    close(fd);
+    if (data == MAP_FAILED)
+        return Program();
+    Program program(deserializeProgram(static_cast<const char*>(data), size));
+    munmap(data, size);
+    return program;
+}
+
+}
@@ -0,0 +1,150 @@
+#include "BehaviorBlockEvaluator.hpp"
+#include "BehaviorKernels.hpp"
+
+#include <algorithm>
+
+namespace Behavior {
+
+BlockEvaluator::BlockEvaluator(const Program& program, const std::size_t blockSize)
+: prog(program),
+  size(std::max<std::size_t>(blockSize, 1)),
+  stride(size + 1),
+  numCyclic(0),
+  values(program.slots() * stride, 0.0),
+  merged(program.merges() * size, 0.0),
+  inputs(program.inputNames.size() * size, 0.0)
+{
+    // Find the cycles, including the ones closed by delayed edges (and self loops)
+    const std::size_t nodes(prog.nodes());
+    std::vector<std::uint32_t> nodeOfSlot(prog.slots());
+    for (std::size_t n = 0; n < nodes; ++n)
+        std::fill(nodeOfSlot.begin() + prog.nodeSlotBegin[n], nodeOfSlot.begin() + prog.nodeSlotBegin[n+1], n);
+    std::vector< std::vector<std::size_t> > successors(nodes);
+    std::vector<bool> selfLoop(nodes, false);
+    for (std::size_t n = 0; n < nodes; ++n)
+    {
+        for (std::uint32_t e = prog.mergeEdgeBegin[prog.nodeMergeBegin[n]]; e < prog.mergeEdgeBegin[prog.nodeMergeBegin[n+1]]; ++e)
+        {
+            const std::size_t source(nodeOfSlot[prog.edgeSource[e]]);
+            if (source == n)
+                selfLoop[n] = true;
+            else
+                successors[source].push_back(n);
+        }
+    }
+    std::size_t count(0);
+    const std::vector<std::size_t> component(componentsOf(successors, count));
+    std::vector<std::size_t> componentSize(count, 0);
+    for (std::size_t n = 0; n < nodes; ++n)
+        componentSize[component[n]]++;
+
+    // Order the components topologically (they are numbered in reverse), the nodes of a component keep their order
+    order.resize(nodes);
+    for (std::size_t n = 0; n < nodes; ++n)
+        order[n] = n;
+    std::stable_sort(order.begin(), order.end(), [&component](const std::uint32_t a, const std::uint32_t b) { return component[a] > component[b]; });
+
+    // Consecutive nodes inside (or outside) of cycles form a group
+    for (std::size_t p = 0; p < nodes; ++p)
+    {
+        const std::size_t n(order[p]);
+        const bool cyclic(selfLoop[n] || (componentSize[component[n]] > 1));
+        if (groups.empty() || (groups.back().cyclic != cyclic))
+            groups.push_back(Group{static_cast<std::uint32_t>(p), static_cast<std::uint32_t>(p), cyclic});
+        groups.back().end++;
+        if (cyclic)
+            numCyclic++;
+    }
+
+    edgeOffset.resize(prog.edges());
+    for (std::size_t e = 0; e < prog.edges(); ++e)
+        edgeOffset[e] = prog.edgeSource[e] * stride + (prog.edgeDelayed[e] ? 0 : 1);
+}
+
+BlockEvaluator::~BlockEvaluator()
+{
+}
+
+void BlockEvaluator::reset()
+{
+    std::fill(values.begin(), values.end(), 0.0);
+    std::fill(merged.begin(), merged.end(), 0.0);
+    std::fill(inputs.begin(), inputs.end(), 0.0);
+}
+
+void BlockEvaluator::process()
+{
+    for (const Group& group : groups)
+    {
+        if (group.cyclic)
+            processSteps(group);
+        else
+            processBlock(group);
+    }
+
+    // The last step is read by the delayed edges of the next block
+    for (std::size_t s = 0; s < prog.slots(); ++s)
+        values[s * stride] = values[s * stride + size];
+}
+
+void BlockEvaluator::processBlock(const Group& group)
+{
+    const double* edgeWeight(prog.edgeWeight.data());
+    for (std::uint32_t p = group.begin; p < group.end; ++p)
+    {
+        const std::uint32_t n(order[p]);
+        const std::uint32_t mergeBegin(prog.nodeMergeBegin[n]);
+        for (std::uint32_t k = mergeBegin; k < prog.nodeMergeBegin[n+1]; ++k)
+        {
+            const std::uint32_t edgeBegin(prog.mergeEdgeBegin[k]);
+            applyMergeBatch(prog.mergeOps[k], prog.mergeBias[k], prog.mergeDefault[k],
+                            edgeOffset.data() + edgeBegin, edgeWeight + edgeBegin, prog.mergeEdgeBegin[k+1] - edgeBegin,
+                            values.data(), 1, size, merged.data() + k * size);
+        }
+
+        const NodeOp op(prog.nodeOps[n]);
+        double* out(values.data() + prog.nodeSlotBegin[n] * stride + 1);
+        if (op == NodeOp::INPUT)
+            std::copy(inputs.begin() + prog.nodePort[n] * size, inputs.begin() + (prog.nodePort[n] + 1) * size, out);
+        else if (op == NodeOp::EXTERN)
+            applyExtern(prog, n, merged.data() + mergeBegin * size, size, out, stride, size);
+        else
+            applyNodeBatch(op, merged.data() + mergeBegin * size, size, out, prog.precision);
+    }
+}
+
+void BlockEvaluator::processSteps(const Group& group)
+{
+    const double* edgeWeight(prog.edgeWeight.data());
+    for (std::size_t t = 0; t < size; ++t)
+    {
+        for (std::uint32_t p = group.begin; p < group.end; ++p)
+        {
+            const std::uint32_t n(order[p]);
+            const std::uint32_t mergeBegin(prog.nodeMergeBegin[n]);
+            const std::uint32_t mergeEnd(prog.nodeMergeBegin[n+1]);
+            // Built-in nodes have at most three inputs (EXTERN nodes read the merges directly)
+            double in[3] = {0.0, 0.0, 0.0};
+            for (std::uint32_t k = mergeBegin; k < mergeEnd; ++k)
+            {
+                const std::uint32_t edgeBegin(prog.mergeEdgeBegin[k]);
+                merged[k * size + t] = applyMerge(prog.mergeOps[k], prog.mergeBias[k], prog.mergeDefault[k],
+                                                  edgeOffset.data() + edgeBegin, edgeWeight + edgeBegin, prog.mergeEdgeBegin[k+1] - edgeBegin,
+                                                  values.data() + t);
+                if (k - mergeBegin < 3)
+                    in[k - mergeBegin] = merged[k * size + t];
+            }
+
+            const NodeOp op(prog.nodeOps[n]);
+            double& out(values[prog.nodeSlotBegin[n] * stride + 1 + t]);
+            if (op == NodeOp::INPUT)
+                out = inputs[prog.nodePort[n] * size + t];
+            else if (op == NodeOp::EXTERN)
+                applyExtern(prog, n, merged.data() + mergeBegin * size + t, size, &out, stride, 1);
+            else
+                out = applyNode(op, in, prog.precision);
+        }
+    }
+}
+
+}
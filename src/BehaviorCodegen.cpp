@@ -0,0 +1,405 @@
+#include "BehaviorCodegen.hpp"
+#include "BehaviorKernels.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace Behavior {
+
+// The keywords and alternative tokens of C++, plus the namespaces the generated code uses
+static const char* const reservedWords[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+    "char", "char16_t", "char32_t", "char8_t", "class", "compl", "concept", "const", "const_cast", "consteval",
+    "constexpr", "constinit", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+    "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+    "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+    "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "std", "struct",
+    "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+    "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+};
+
+// Turns a name into a valid C++ identifier (reserved words get a trailing '_')
+static std::string identifierOf(const std::string& name)
+{
+    std::string result;
+    for (const char c : name)
+        result += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    if (result.empty() || std::isdigit(static_cast<unsigned char>(result[0])))
+        result = "_" + result;
+    for (const char* word : reservedWords)
+    {
+        if (result == word)
+            return result + "_";
+    }
+    return result;
+}
+
+// Prints a double such that it is parsed back exactly
+static std::string literalOf(const double value)
+{
+    if (std::isnan(value))
+        return "std::numeric_limits<double>::quiet_NaN()";
+    if (std::isinf(value))
+        return value > 0.0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", value);
+    std::string result(buf);
+    if (result.find_first_of(".en") == std::string::npos)
+        result += ".0";
+    return result;
+}
+
+// Turns a text into a string literal (also used in comments, so no line ends in a backslash)
+// Control characters become octal escapes, '?' is escaped to rule out trigraphs
+static std::string quotedOf(const std::string& text)
+{
+    std::string result("\"");
+    for (const char c : text)
+    {
+        const unsigned char u(static_cast<unsigned char>(c));
+        if ((c == '"') || (c == '\\') || (c == '?'))
+        {
+            result += '\\';
+            result += c;
+        } else if ((u < 0x20) || (u == 0x7f)) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\%03o", u);
+            result += buf;
+        } else {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+// Emits 'const char* name[] = {...}' with a trailing nullptr (so empty interfaces are valid, too)
+static void emitNames(std::ostream& os, const std::string& name, const Symbols& names, const SymbolTable& symbols)
+{
+    os << "static constexpr const char* " << name << "[] = {";
+    for (const Symbol n : names)
+        os << quotedOf(symbols.str(n)) << ", ";
+    os << "nullptr};\n";
+}
+
+// Emits an array of constants (at least one element)
+static void emitConstants(std::ostream& os, const std::string& name, const std::vector<double>& values)
+{
+    os << "static constexpr double " << name << "[] = {";
+    for (std::size_t i = 0; i < values.size(); ++i)
+        os << (i ? ", " : "") << literalOf(values[i]);
+    if (values.empty())
+        os << "0.0";
+    os << "};\n";
+}
+
+// Prints a finite double as Static::Constant<mantissa, exponent>
+static std::string constantOf(const double value)
+{
+    int exponent(0);
+    std::int64_t mantissa(static_cast<std::int64_t>(std::ldexp(std::frexp(value, &exponent), 53)));
+    exponent -= 53;
+    if (!mantissa)
+        exponent = 0;
+    while (mantissa && !(mantissa % 2))
+    {
+        mantissa /= 2;
+        ++exponent;
+    }
+    return "S::Constant<" + std::to_string(mantissa) + ", " + std::to_string(exponent) + ">";
+}
+
+static bool isGeneratable(const Program& program)
+{
+    for (const NodeOp op : program.nodeOps)
+    {
+        if ((op == NodeOp::EXTERN) || (op == NodeOp::SUBGRAPH))
+            return false;
+    }
+    return true;
+}
+
+static std::string nameOf(const Precision precision)
+{
+    switch (precision)
+    {
+        case Precision::HIGH: return "HIGH";
+        case Precision::LOW: return "LOW";
+        default: return "EXACT";
+    }
+}
+
+// Returns the name of the function computing a node
+static std::string functionOf(const NodeOp op, const Precision precision)
+{
+    const std::string precisionName(precision == Precision::EXACT ? "" : "Behavior::Precision::" + nameOf(precision));
+    const std::string fast(precisionName.empty() ? "std::" : "Behavior::FastMath::");
+    const std::string suffix(precisionName.empty() ? "" : "<" + precisionName + ">");
+    switch (op)
+    {
+        case NodeOp::SIN:
+            return fast + "sin" + suffix;
+        case NodeOp::COS:
+            return fast + "cos" + suffix;
+        case NodeOp::TAN:
+            return "std::tan";
+        case NodeOp::TANH:
+            return fast + "tanh" + suffix;
+        case NodeOp::ACOS:
+            return "std::acos";
+        case NodeOp::ASIN:
+            return "std::asin";
+        case NodeOp::ATAN:
+            return fast + "atan" + suffix;
+        case NodeOp::LOG:
+            return fast + "log" + suffix;
+        case NodeOp::EXP:
+            return fast + "exp" + suffix;
+        case NodeOp::ABS:
+            return "std::fabs";
+        case NodeOp::SQRT:
+            return "std::sqrt";
+        case NodeOp::ATAN2:
+            return fast + "atan2" + suffix;
+        case NodeOp::POW:
+            return fast + "pow" + suffix;
+        case NodeOp::MOD:
+            return "std::fmod";
+        default:
+            return "";
+    }
+}
+
+std::string generateCpp(const Program& program, const std::string& name)
+{
+    if (!isGeneratable(program))
+        return std::string();
+
+    const std::string ns(identifierOf(name.empty() ? program.name : name));
+    const bool isBuffered(program.buffers() > 1);
+    std::ostringstream os;
+
+    os << "// Generated from the behavior graph " << quotedOf(program.name) << " (" << program.nodes() << " nodes, "
+       << program.merges() << " merges, " << program.edges() << " edges)\n";
+    os << "// Do not edit\n";
+    os << "#ifndef _BEHAVIOUR_GENERATED_" << ns << "_HPP\n";
+    os << "#define _BEHAVIOUR_GENERATED_" << ns << "_HPP\n\n";
+    os << "#include <algorithm>\n";
+    os << "#include <cmath>\n";
+    os << "#include <cstddef>\n";
+    os << "#include <limits>\n";
+    if (program.precision != Precision::EXACT)
+        os << "#include \"BehaviorFastMath.hpp\"\n";
+    os << "\nnamespace " << ns << " {\n\n";
+
+    // Interface and constants
+    os << "static constexpr std::size_t inputs = " << program.inputNames.size() << ";\n";
+    os << "static constexpr std::size_t outputs = " << program.outputNames.size() << ";\n";
+    os << "static constexpr std::size_t slots = " << program.slots() << ";\n";
+    os << "static constexpr std::size_t buffers = " << program.buffers() << ";\n";
+    emitNames(os, "inputNames", program.inputNames, program.symbols);
+    emitNames(os, "outputNames", program.outputNames, program.symbols);
+    os << "\n";
+    emitConstants(os, "weights", program.edgeWeight);
+    emitConstants(os, "biases", program.mergeBias);
+    emitConstants(os, "defaults", program.mergeDefault);
+    os << "\n";
+
+    // State
+    os << "// The outputs of all nodes" << (isBuffered ? " (two buffers, every step writes the other one)" : "") << "\n";
+    os << "struct State\n{\n";
+    os << "    double values[slots * buffers > 0 ? slots * buffers : 1];\n";
+    os << "    std::size_t buffer;\n";
+    os << "};\n\n";
+    os << "inline void reset(State& state)\n{\n";
+    os << "    for (std::size_t i = 0; i < slots * buffers; ++i)\n";
+    os << "        state.values[i] = 0.0;\n";
+    os << "    state.buffer = 0;\n";
+    os << "}\n\n";
+
+    // Step
+    os << "// Evaluates all nodes once: Reads in[inputs] and writes out[outputs]\n";
+    os << "inline void step(State& state, const double* in, double* out)\n{\n";
+    if (isBuffered)
+    {
+        os << "    state.buffer ^= 1;\n";
+        os << "    double* const v(state.values + state.buffer * slots);\n";
+        os << "    const double* const p(state.values + (state.buffer ^ 1) * slots);\n";
+        os << "    (void)p;\n";
+    } else {
+        os << "    double* const v(state.values);\n";
+    }
+    if (program.nodes() == 0)
+        os << "    (void)v;\n";
+    if (program.inputNames.empty())
+        os << "    (void)in;\n";
+    for (std::size_t n = 0; n < program.nodes(); ++n)
+    {
+        const NodeOp op(program.nodeOps[n]);
+        const std::uint32_t slot(program.nodeSlotBegin[n]);
+        os << "    // " << quotedOf(program.symbols.str(program.nodeNames[n])) << "\n";
+        if (op == NodeOp::INPUT)
+        {
+            os << "    v[" << slot << "] = in[" << program.nodePort[n] << "];\n";
+            continue;
+        }
+
+        // Merges
+        std::vector<std::string> merged;
+        for (std::uint32_t k = program.nodeMergeBegin[n]; k < program.nodeMergeBegin[n+1]; ++k)
+        {
+            const std::uint32_t edgeBegin(program.mergeEdgeBegin[k]);
+            const std::uint32_t edgeEnd(program.mergeEdgeBegin[k+1]);
+            const std::string m("m" + std::to_string(k));
+            merged.push_back(m);
+            if (edgeBegin == edgeEnd)
+            {
+                os << "    const double " << m << "(defaults[" << k << "]);\n";
+                continue;
+            }
+            std::vector<std::string> terms;
+            for (std::uint32_t e = edgeBegin; e < edgeEnd; ++e)
+            {
+                const std::string source(((isBuffered && program.edgeDelayed[e]) ? "p[" : "v[") + std::to_string(program.edgeSource[e]) + "]");
+                terms.push_back("weights[" + std::to_string(e) + "] * " + source);
+            }
+            // Same order of operations as applyMerge
+            std::string expr("(" + terms[0] + ")");
+            switch (program.mergeOps[k])
+            {
+                case MergeOp::SUM:
+                case MergeOp::MEAN:
+                    for (std::size_t t = 1; t < terms.size(); ++t)
+                        expr += " + " + terms[t];
+                    if (program.mergeOps[k] == MergeOp::MEAN)
+                        expr = "(" + expr + ") / " + literalOf(terms.size());
+                    break;
+                case MergeOp::PRODUCT:
+                    for (std::size_t t = 1; t < terms.size(); ++t)
+                        expr += " * (" + terms[t] + ")";
+                    break;
+                case MergeOp::MIN:
+                case MergeOp::MAX:
+                    for (std::size_t t = 1; t < terms.size(); ++t)
+                        expr = std::string(program.mergeOps[k] == MergeOp::MIN ? "std::min(" : "std::max(") + expr + ", " + terms[t] + ")";
+                    break;
+                case MergeOp::NORM:
+                    expr = expr + " * " + expr;
+                    for (std::size_t t = 1; t < terms.size(); ++t)
+                        expr += " + (" + terms[t] + ") * (" + terms[t] + ")";
+                    expr = "std::sqrt(" + expr + ")";
+                    break;
+            }
+            os << "    const double " << m << "(" << expr << " + biases[" << k << "]);\n";
+        }
+
+        // Node
+        std::string value;
+        switch (op)
+        {
+            case NodeOp::PIPE:
+            case NodeOp::OUTPUT:
+                value = merged[0];
+                break;
+            case NodeOp::DIVIDE:
+                value = "1.0 / " + merged[0];
+                break;
+            case NodeOp::GREATER_ZERO:
+                value = merged[0] + " > 0.0 ? " + merged[1] + " : " + merged[2];
+                break;
+            case NodeOp::APPROX_ZERO:
+                value = "std::fabs(" + merged[0] + ") < " + literalOf(ApproxZeroEpsilon) + " ? " + merged[1] + " : " + merged[2];
+                break;
+            default:
+                value = functionOf(op, program.precision) + "(" + merged[0];
+                for (std::size_t i = 1; i < merged.size(); ++i)
+                    value += ", " + merged[i];
+                value += ")";
+                break;
+        }
+        os << "    v[" << slot << "] = " << value << ";\n";
+    }
+    for (std::size_t o = 0; o < program.outputSlots.size(); ++o)
+        os << "    out[" << o << "] = v[" << program.outputSlots[o] << "];\n";
+    if (program.outputSlots.empty())
+        os << "    (void)out;\n";
+    os << "}\n\n";
+
+    os << "}\n\n";
+    os << "#endif\n";
+    return os.str();
+}
+
+std::string generateStaticCpp(const Program& program, const std::string& name)
+{
+    if (!isGeneratable(program))
+        return std::string();
+    std::vector<const std::vector<double>*> constants{&program.edgeWeight, &program.mergeBias, &program.mergeDefault};
+    for (const std::vector<double>* values : constants)
+    {
+        for (const double value : *values)
+        {
+            if (!std::isfinite(value))
+                return std::string();
+        }
+    }
+
+    const std::string ns(identifierOf(name.empty() ? program.name : name));
+    const bool isBuffered(program.buffers() > 1);
+    std::ostringstream os;
+
+    os << "// Generated from the behavior graph " << quotedOf(program.name) << " (" << program.nodes() << " nodes, "
+       << program.merges() << " merges, " << program.edges() << " edges)\n";
+    os << "// Do not edit\n";
+    os << "#ifndef _BEHAVIOUR_GENERATED_" << ns << "_HPP\n";
+    os << "#define _BEHAVIOUR_GENERATED_" << ns << "_HPP\n\n";
+    os << "#include \"BehaviorStatic.hpp\"\n";
+    os << "\nnamespace " << ns << " {\n\n";
+    os << "namespace S = Behavior::Static;\n";
+    os << "using Behavior::NodeOp;\n";
+    os << "using Behavior::MergeOp;\n\n";
+    emitNames(os, "inputNames", program.inputNames, program.symbols);
+    emitNames(os, "outputNames", program.outputNames, program.symbols);
+    os << "\n";
+
+    os << "typedef S::Graph<Behavior::Precision::" << nameOf(program.precision) << ", " << program.inputNames.size() << ", "
+       << program.slots() << ", " << program.buffers() << ",\n";
+    os << "    S::Outputs<";
+    for (std::size_t o = 0; o < program.outputSlots.size(); ++o)
+        os << (o ? ", " : "") << program.outputSlots[o];
+    os << ">";
+    for (std::size_t n = 0; n < program.nodes(); ++n)
+    {
+        const NodeOp op(program.nodeOps[n]);
+        const std::uint32_t slot(program.nodeSlotBegin[n]);
+        os << ",\n    ";
+        if (op == NodeOp::INPUT)
+        {
+            os << "S::Input<" << slot << ", " << program.nodePort[n] << ">";
+            continue;
+        }
+        os << "S::Node<NodeOp::" << nameOf(op) << ", " << slot;
+        for (std::uint32_t k = program.nodeMergeBegin[n]; k < program.nodeMergeBegin[n+1]; ++k)
+        {
+            os << ",\n        S::Merge<MergeOp::" << nameOf(program.mergeOps[k]) << ", "
+               << constantOf(program.mergeBias[k]) << ", " << constantOf(program.mergeDefault[k]);
+            for (std::uint32_t e = program.mergeEdgeBegin[k]; e < program.mergeEdgeBegin[k+1]; ++e)
+            {
+                os << ",\n            S::Edge<" << program.edgeSource[e] << ", " << constantOf(program.edgeWeight[e])
+                   << ((isBuffered && program.edgeDelayed[e]) ? ", true" : "") << ">";
+            }
+            os << ">";
+        }
+        os << ">";
+    }
+    os << "\n> Model;\n\n";
+
+    os << "}\n\n";
+    os << "#endif\n";
+    return os.str();
+}
+
+}
@@ -0,0 +1,329 @@
+#include "BehaviorEvaluator.hpp"
+#include "BehaviorKernels.hpp"
+
+#include <algorithm>
+#include <map>
+
+namespace Behavior {
+
+Evaluator::Evaluator(const Program& program, const SimdLevel level, const bool useLayers)
+: prog(program),
+  mergeKernel(mergeKernelFor(level)),
+  denseKernel(denseKernelFor(level)),
+  layered(useLayers),
+  values(program.slots() * program.buffers(), 0.0),
+  merged(program.merges(), 0.0),
+  inputs(program.inputNames.size(), 0.0),
+  buffer(0),
+  offset(0)
+{
+    for (std::size_t b = 0; b < prog.buffers(); ++b)
+        sources[b] = prog.sourcesOf(b);
+    if (layered)
+        plan = planLayers(prog);
+    kept.reserve(prog.slots());
+}
+
+Evaluator::~Evaluator()
+{
+}
+
+void Evaluator::reset()
+{
+    std::fill(values.begin(), values.end(), 0.0);
+    std::fill(merged.begin(), merged.end(), 0.0);
+    std::fill(inputs.begin(), inputs.end(), 0.0);
+    buffer = 0;
+    offset = 0;
+}
+
+void Evaluator::step()
+{
+    // Every step writes the buffer read by the next one
+    buffer = (buffer + 1) % prog.buffers();
+    offset = buffer * prog.slots();
+    const std::uint32_t* edgeSource(sources[buffer].data());
+    double* out(values.data() + offset);
+    std::size_t n(0);
+    for (const Layer& layer : plan.layers)
+    {
+        evaluateNodes(prog, n, layer.nodeBegin, mergeKernel, edgeSource, inputs.data(), values.data(), out, merged.data());
+        evaluateLayer(prog, plan, layer, mergeKernel, denseKernel, edgeSource, inputs.data(), values.data(), out, merged.data());
+        n = layer.nodeEnd;
+    }
+    evaluateNodes(prog, n, prog.nodes(), mergeKernel, edgeSource, inputs.data(), values.data(), out, merged.data());
+}
+
+std::size_t Evaluator::demand(const std::vector<std::size_t>& outputs)
+{
+    // The same set of outputs in any order yields the same schedule
+    std::vector<std::string> names;
+    for (const std::size_t idx : outputs)
+    {
+        if (idx >= prog.outputNames.size())
+            return Program::npos;
+        names.push_back(prog.symbols.str(prog.outputNames[idx]));
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    std::map<std::vector<std::string>, std::size_t>::const_iterator it(schedulesByOutputs.find(names));
+    if (it != schedulesByOutputs.end())
+        return it->second;
+    schedules.push_back(scheduleOf(names));
+    schedulesByOutputs[names] = schedules.size() - 1;
+    return schedules.size() - 1;
+}
+
+void Evaluator::step(const std::size_t schedule)
+{
+    const double* previous(values.data() + offset);
+    buffer = (buffer + 1) % prog.buffers();
+    offset = buffer * prog.slots();
+    const std::uint32_t* edgeSource(sources[buffer].data());
+    double* out(values.data() + offset);
+    // Double buffered programs carry the slots of the nodes not evaluated over into the new buffer
+    const bool carry(prog.buffers() > 1);
+    std::uint32_t slot(0);
+    for (const Segment& segment : schedules[schedule])
+    {
+        if (carry)
+            std::copy(previous + slot, previous + prog.nodeSlotBegin[segment.begin], out + slot);
+        slot = prog.nodeSlotBegin[segment.end];
+        if (segment.layer == Program::npos)
+        {
+            evaluateNodes(prog, segment.begin, segment.end, mergeKernel, edgeSource, inputs.data(), values.data(), out, merged.data());
+            continue;
+        }
+
+        // The skipped nodes of a layer keep their values (these are still in the previous buffer if double buffered)
+        kept.clear();
+        if (!carry)
+        {
+            for (const std::uint32_t n : segment.skipped)
+                kept.insert(kept.end(), out + prog.nodeSlotBegin[n], out + prog.nodeSlotBegin[n+1]);
+        }
+        evaluateLayer(prog, plan, plan.layers[segment.layer], mergeKernel, denseKernel, edgeSource, inputs.data(), values.data(), out, merged.data());
+        const double* from(kept.data());
+        for (const std::uint32_t n : segment.skipped)
+        {
+            const std::uint32_t begin(prog.nodeSlotBegin[n]);
+            const std::uint32_t end(prog.nodeSlotBegin[n+1]);
+            if (carry)
+            {
+                std::copy(previous + begin, previous + end, out + begin);
+            } else {
+                std::copy(from, from + (end - begin), out + begin);
+                from += end - begin;
+            }
+        }
+    }
+    if (carry)
+        std::copy(previous + slot, previous + prog.slots(), out + slot);
+}
+
+std::vector<Evaluator::Segment> Evaluator::scheduleOf(const std::vector<std::string>& outputs) const
+{
+    // Outputs removed by an update are dropped
+    std::vector<std::size_t> indices;
+    for (const std::string& name : outputs)
+    {
+        const std::size_t idx(prog.outputIndex(name));
+        if (idx != Program::npos)
+            indices.push_back(idx);
+    }
+    const std::vector<bool> demanded(prog.demandOf(indices));
+
+    std::vector<Segment> segments;
+    std::size_t layer(0);
+    for (std::uint32_t n = 0; n < prog.nodes();)
+    {
+        while ((layer < plan.layers.size()) && (plan.layers[layer].nodeEnd <= n))
+            layer++;
+        if (!demanded[n])
+        {
+            n++;
+            continue;
+        }
+
+        // Layers are evaluated in bulk if most of their nodes are needed (no needed node reads the others)
+        if ((layer < plan.layers.size()) && (plan.layers[layer].nodeBegin == n) &&
+            (2 * std::count(demanded.begin() + n, demanded.begin() + plan.layers[layer].nodeEnd, true) >= plan.layers[layer].nodeEnd - n))
+        {
+            segments.push_back(Segment{n, plan.layers[layer].nodeEnd, layer, std::vector<std::uint32_t>()});
+            for (; n < plan.layers[layer].nodeEnd; ++n)
+            {
+                if (!demanded[n])
+                    segments.back().skipped.push_back(n);
+            }
+            continue;
+        }
+        if (!segments.empty() && (segments.back().layer == Program::npos) && (segments.back().end == n))
+            segments.back().end++;
+        else
+            segments.push_back(Segment{n, n + 1, Program::npos, std::vector<std::uint32_t>()});
+        n++;
+    }
+    return segments;
+}
+
+// Counting sort of the entities by the symbols of their uids
+template<typename Index> static void indexUids(const Symbols& uids, const std::size_t symbols, Index& index)
+{
+    index.begin.assign(symbols + 1, 0);
+    for (const Symbol uid : uids)
+        index.begin[uid + 1]++;
+    for (std::size_t s = 0; s < symbols; ++s)
+        index.begin[s + 1] += index.begin[s];
+    index.entries.resize(uids.size());
+    std::vector<std::uint32_t> next(index.begin.begin(), index.begin.end() - 1);
+    for (std::size_t i = 0; i < uids.size(); ++i)
+        index.entries[next[uids[i]]++] = i;
+}
+
+// The entities [first, last) of index.entries having the given uid
+template<typename Index> static std::size_t lookup(const Index& index, const SymbolTable& symbols, const UniqueId& uid, std::size_t& first, std::size_t& last)
+{
+    const Symbol symbol(symbols.find(uid));
+    first = last = 0;
+    if (symbol < index.begin.size() - 1)
+    {
+        first = index.begin[symbol];
+        last = index.begin[symbol + 1];
+    }
+    return last - first;
+}
+
+void Evaluator::reindex()
+{
+    indexUids(prog.nodeUids, prog.symbols.size(), nodesByUid);
+    indexUids(prog.mergeUids, prog.symbols.size(), mergesByUid);
+    indexUids(prog.edgeUids, prog.symbols.size(), edgesByUid);
+    for (std::size_t b = 0; b < prog.buffers(); ++b)
+        sources[b] = prog.sourcesOf(b);
+}
+
+bool Evaluator::update(const Updates& updates)
+{
+    const bool applied(applyUpdates(updates));
+    // The dense layers hold copies of the weights and the schedules refer to nodes and layers
+    if (layered)
+        plan = planLayers(prog);
+    for (const std::pair<const std::vector<std::string>, std::size_t>& entry : schedulesByOutputs)
+        schedules[entry.second] = scheduleOf(entry.first);
+    return applied;
+}
+
+bool Evaluator::applyUpdates(const Updates& updates)
+{
+    if (nodesByUid.begin.empty())
+        reindex();
+    std::size_t first, last;
+    for (const Update& change : updates)
+    {
+        switch (change.kind)
+        {
+            case Update::Kind::WEIGHT:
+                if (!lookup(edgesByUid, prog.symbols, change.uid, first, last))
+                    return false;
+                for (std::size_t i = first; i < last; ++i)
+                    prog.edgeWeight[edgesByUid.entries[i]] = change.value;
+                break;
+            case Update::Kind::BIAS:
+            case Update::Kind::DEFAULT:
+                if (!lookup(mergesByUid, prog.symbols, change.uid, first, last))
+                    return false;
+                for (std::size_t i = first; i < last; ++i)
+                    (change.kind == Update::Kind::BIAS ? prog.mergeBias : prog.mergeDefault)[mergesByUid.entries[i]] = change.value;
+                break;
+            case Update::Kind::ADD_EDGE:
+                if (!addEdge(change))
+                    return false;
+                break;
+            case Update::Kind::REMOVE_EDGE:
+                if (!lookup(edgesByUid, prog.symbols, change.uid, first, last))
+                    return false;
+                // The entries are sorted, so removing the last one first keeps the others valid
+                for (std::size_t i = last; i-- > first;)
+                    prog.removeEdge(edgesByUid.entries[i]);
+                reindex();
+                break;
+        }
+    }
+    return true;
+}
+
+bool Evaluator::addEdge(const Update& change)
+{
+    std::size_t first, last;
+    if (lookup(mergesByUid, prog.symbols, change.uid, first, last) != 1)
+        return false;
+    const std::size_t merge(mergesByUid.entries[first]);
+    if (lookup(nodesByUid, prog.symbols, change.source, first, last) != 1)
+        return false;
+    const std::size_t source(nodesByUid.entries[first]);
+    if (prog.nodeSlotBegin[source] + change.output >= prog.nodeSlotBegin[source + 1])
+        return false;
+
+    // A source on an earlier level is evaluated before the reader in every order of the nodes
+    const std::size_t reader(prog.nodeOf(merge));
+    if (prog.levelOf(source) < prog.levelOf(reader))
+    {
+        prog.insertEdge(merge, prog.nodeSlotBegin[source] + change.output, change.value, false, change.edge);
+        reindex();
+        return true;
+    }
+
+    Netlist netlist(netlistOf(prog));
+    Netlist::Edge edge{source, change.output, change.value, change.edge, false};
+    netlist.nodes[reader].inputs[merge - prog.nodeMergeBegin[reader]].edges.push_back(edge);
+    replan(netlist);
+    return true;
+}
+
+void Evaluator::replan(const Netlist& netlist)
+{
+    Program next(netlist, prog.precision, prog.feedback);
+
+    // The EXTERN nodes keep their functions
+    ExternRegistry externs;
+    for (std::size_t x = 0; x < prog.externNames.size(); ++x)
+        externs.bind(prog.symbols.str(prog.externNames[x]), prog.externBindings[x].function, prog.externBindings[x].context);
+    bindExterns(next, externs);
+
+    // Carry over the outputs of all nodes (identified by name and uid) and the inputs (by name)
+    typedef std::pair<std::string, std::string> Key;
+    std::map<Key, std::size_t> nodeOf;
+    for (std::size_t n = 0; n < prog.nodes(); ++n)
+        nodeOf[Key(prog.symbols.str(prog.nodeNames[n]), prog.symbols.str(prog.nodeUids[n]))] = n;
+    std::vector<double> nextValues(next.slots() * next.buffers(), 0.0);
+    for (std::size_t n = 0; n < next.nodes(); ++n)
+    {
+        std::map<Key, std::size_t>::const_iterator it(nodeOf.find(Key(next.symbols.str(next.nodeNames[n]), next.symbols.str(next.nodeUids[n]))));
+        if (it == nodeOf.end())
+            continue;
+        for (std::size_t b = 0; b < next.buffers(); ++b)
+        {
+            // A single buffer is copied into both buffers
+            const double* from(values.data() + std::min(b, prog.buffers() - 1) * prog.slots() + prog.nodeSlotBegin[it->second]);
+            std::copy(from, from + (next.nodeSlotBegin[n + 1] - next.nodeSlotBegin[n]), nextValues.begin() + b * next.slots() + next.nodeSlotBegin[n]);
+        }
+    }
+    std::vector<double> nextInputs(next.inputNames.size(), 0.0);
+    for (std::size_t i = 0; i < nextInputs.size(); ++i)
+    {
+        const std::size_t idx(prog.inputIndex(next.symbols.str(next.inputNames[i])));
+        if (idx != Program::npos)
+            nextInputs[i] = inputs[idx];
+    }
+
+    prog = next;
+    values.swap(nextValues);
+    inputs.swap(nextInputs);
+    merged.assign(prog.merges(), 0.0);
+    kept.reserve(prog.slots());
+    buffer = std::min(buffer, prog.buffers() - 1);
+    offset = buffer * prog.slots();
+    reindex();
+}
+
+}
@@ -0,0 +1,35 @@
+#include "BehaviorExtern.hpp"
+#include "BehaviorProgram.hpp"
+
+namespace Behavior {
+
+void ExternRegistry::bind(const std::string& externName, const BehaviorExternFunction function, void* context)
+{
+    bindings[externName] = ExternBinding{function, context};
+}
+
+void ExternRegistry::unbind(const std::string& externName)
+{
+    bindings.erase(externName);
+}
+
+const ExternBinding* ExternRegistry::find(const std::string& externName) const
+{
+    std::map<std::string, ExternBinding>::const_iterator it(bindings.find(externName));
+    return it != bindings.end() ? &it->second : NULL;
+}
+
+std::size_t bindExterns(Program& program, const ExternRegistry& registry)
+{
+    std::size_t unbound(0);
+    for (std::size_t x = 0; x < program.externNames.size(); ++x)
+    {
+        const ExternBinding* binding(registry.find(program.symbols.str(program.externNames[x])));
+        program.externBindings[x] = binding ? *binding : ExternBinding{NULL, NULL};
+        if (!binding)
+            unbound++;
+    }
+    return unbound;
+}
+
+}
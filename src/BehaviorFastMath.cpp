@@ -0,0 +1,126 @@
+#include "BehaviorFastMath.hpp"
+
+// The loops below are compiled for several instruction sets and dispatched at load time
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define BEHAVIOR_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define BEHAVIOR_TARGET_CLONES
+#endif
+
+namespace Behavior {
+namespace FastMath {
+
+#define BEHAVIOR_UNARY_LOOP(f, P) \
+    for (std::size_t i = 0; i < n; ++i) \
+        y[i] = f<P>(x[i]);
+
+#define BEHAVIOR_BINARY_LOOP(f, P, a, b) \
+    for (std::size_t i = 0; i < n; ++i) \
+        z[i] = f<P>(a[i], b[i]);
+
+BEHAVIOR_TARGET_CLONES
+void sin(const double* x, double* y, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_UNARY_LOOP(sin, Precision::EXACT)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_UNARY_LOOP(sin, Precision::LOW)
+    } else {
+        BEHAVIOR_UNARY_LOOP(sin, Precision::HIGH)
+    }
+}
+
+BEHAVIOR_TARGET_CLONES
+void cos(const double* x, double* y, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_UNARY_LOOP(cos, Precision::EXACT)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_UNARY_LOOP(cos, Precision::LOW)
+    } else {
+        BEHAVIOR_UNARY_LOOP(cos, Precision::HIGH)
+    }
+}
+
+BEHAVIOR_TARGET_CLONES
+void tanh(const double* x, double* y, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_UNARY_LOOP(tanh, Precision::EXACT)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_UNARY_LOOP(tanh, Precision::LOW)
+    } else {
+        BEHAVIOR_UNARY_LOOP(tanh, Precision::HIGH)
+    }
+}
+
+BEHAVIOR_TARGET_CLONES
+void exp(const double* x, double* y, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_UNARY_LOOP(exp, Precision::EXACT)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_UNARY_LOOP(exp, Precision::LOW)
+    } else {
+        BEHAVIOR_UNARY_LOOP(exp, Precision::HIGH)
+    }
+}
+
+BEHAVIOR_TARGET_CLONES
+void log(const double* x, double* y, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_UNARY_LOOP(log, Precision::EXACT)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_UNARY_LOOP(log, Precision::LOW)
+    } else {
+        BEHAVIOR_UNARY_LOOP(log, Precision::HIGH)
+    }
+}
+
+BEHAVIOR_TARGET_CLONES
+void atan(const double* x, double* y, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_UNARY_LOOP(atan, Precision::EXACT)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_UNARY_LOOP(atan, Precision::LOW)
+    } else {
+        BEHAVIOR_UNARY_LOOP(atan, Precision::HIGH)
+    }
+}
+
+BEHAVIOR_TARGET_CLONES
+void atan2(const double* y, const double* x, double* z, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_BINARY_LOOP(atan2, Precision::EXACT, y, x)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_BINARY_LOOP(atan2, Precision::LOW, y, x)
+    } else {
+        BEHAVIOR_BINARY_LOOP(atan2, Precision::HIGH, y, x)
+    }
+}
+
+BEHAVIOR_TARGET_CLONES
+void pow(const double* x, const double* y, double* z, const std::size_t n, const Precision p)
+{
+    if (p == Precision::EXACT)
+    {
+        BEHAVIOR_BINARY_LOOP(pow, Precision::EXACT, x, y)
+    } else if (p == Precision::LOW) {
+        BEHAVIOR_BINARY_LOOP(pow, Precision::LOW, x, y)
+    } else {
+        BEHAVIOR_BINARY_LOOP(pow, Precision::HIGH, x, y)
+    }
+}
+
+}
+}
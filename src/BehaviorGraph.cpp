@@ -1,7 +1,15 @@
 #include "BehaviorGraph.hpp"
 #include <yaml-cpp/yaml.h>
+#include <yaml-cpp/eventhandler.h>
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <atomic>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Behavior {
 
@@ -15,8 +23,38 @@ const UniqueId Graph::MergeInterfaceId = "Behavior::Graph::Merge::Interface";
 const UniqueId Graph::InterfaceValueId = "Behavior::Graph::Interface::Value";
 
 // Predefined nodes & merges
+const UniqueId Graph::SumId = "Behavior::Graph::Merge::Sum";
+const UniqueId Graph::ProductId = "Behavior::Graph::Merge::Product";
+const UniqueId Graph::MinId = "Behavior::Graph::Merge::Min";
+const UniqueId Graph::MaxId = "Behavior::Graph::Merge::Max";
+const UniqueId Graph::MeanId = "Behavior::Graph::Merge::Mean";
+const UniqueId Graph::NormId = "Behavior::Graph::Merge::Norm";
+
+const UniqueId Graph::Arity1Id = "Behavior::Graph::Node::1-1";
+const UniqueId Graph::PipeId = "Behavior::Graph::Node::Pipe";
 const UniqueId Graph::InputNodeId = "Behavior::Graph::Node::Input";
 const UniqueId Graph::OutputNodeId = "Behavior::Graph::Node::Output";
+const UniqueId Graph::DivideId = "Behavior::Graph::Node::Divide";
+const UniqueId Graph::SineId = "Behavior::Graph::Node::Sine";
+const UniqueId Graph::CosineId = "Behavior::Graph::Node::Cosine";
+const UniqueId Graph::TangensId = "Behavior::Graph::Node::Tangens";
+const UniqueId Graph::TangensHyperbolicusId = "Behavior::Graph::Node::TangensHyperbolicus";
+const UniqueId Graph::ArcusCosineId = "Behavior::Graph::Node::ArcusCosine";
+const UniqueId Graph::ArcusSineId = "Behavior::Graph::Node::ArcusSine";
+const UniqueId Graph::ArcusTangensId = "Behavior::Graph::Node::ArcusTangens";
+const UniqueId Graph::LogarithmId = "Behavior::Graph::Node::Logarithm";
+const UniqueId Graph::ExponentialId = "Behavior::Graph::Node::Exponential";
+const UniqueId Graph::AbsoluteId = "Behavior::Graph::Node::Absolute";
+const UniqueId Graph::SquareRootId = "Behavior::Graph::Node::SquareRoot";
+
+const UniqueId Graph::Arity2Id = "Behavior::Graph::Node::2-1";
+const UniqueId Graph::ArcusTangens2Id = "Behavior::Graph::Node::ArcusTangens2D";
+const UniqueId Graph::PowerId = "Behavior::Graph::Node::Power";
+const UniqueId Graph::ModuloId = "Behavior::Graph::Node::Modulo";
+
+const UniqueId Graph::Arity3Id = "Behavior::Graph::Node::3-1";
+const UniqueId Graph::GreaterZeroId = "Behavior::Graph::Node::GreaterZero";
+const UniqueId Graph::ApproxZeroId = "Behavior::Graph::Node::ApproxZero";
 
 // TODO: Move these to a BGRAPH Generator class!
 //const UniqueId Graph::CId = "Behavior::Graph::Interface::C";
@@ -24,17 +62,85 @@ const UniqueId Graph::OutputNodeId = "Behavior::Graph::Node::Output";
 //const UniqueId Graph::CValueId = "Behavior::Graph::Interface::Value::C";
 //const UniqueId Graph::VHDLValueId = "Behavior::Graph::Interface::Value::VHDL";
 
+// Parses a whole label as real number (value is left untouched if the label is no number)
+static bool parseReal(const std::string& text, double& value)
+{
+    char* end(NULL);
+    const double parsed(std::strtod(text.c_str(), &end));
+    if (text.empty() || (end != text.c_str() + text.size()))
+        return false;
+    value = parsed;
+    return true;
+}
+
+// Formats a real number such that parseReal yields the same number again (integral numbers keep a '.0')
+static std::string formatReal(const double value)
+{
+    std::ostringstream text;
+    text.precision(15);
+    text << value;
+    double parsed;
+    if (!parseReal(text.str(), parsed) || (parsed != value))
+    {
+        text.str("");
+        text.precision(17);
+        text << value;
+    }
+    if (text.str().find_first_of(".eEn") == std::string::npos)
+        text << ".0";
+    return text.str();
+}
+
 Graph::Graph()
+: Software::Network(metaModel())
 {
-    setupMetaModel();
 }
 
 Graph::Graph(const Hypergraph& base)
 : Software::Network(base)
+{
+    // setupMetaModel() does not change anything if all classes exist (their interfaces are only created together with them)
+    const UniqueId* classUids[] = {
+        &InterfaceId, &MergeInterfaceId, &InterfaceValueId, &NodeId, &MergeId, &EdgeId, &ExternId, &SubgraphId,
+        &SumId, &ProductId, &MinId, &MaxId, &MeanId, &NormId,
+        &Arity1Id, &PipeId, &InputNodeId, &OutputNodeId, &DivideId, &SineId, &CosineId, &TangensId, &TangensHyperbolicusId,
+        &ArcusCosineId, &ArcusSineId, &ArcusTangensId, &LogarithmId, &ExponentialId, &AbsoluteId, &SquareRootId,
+        &Arity2Id, &ArcusTangens2Id, &PowerId, &ModuloId,
+        &Arity3Id, &GreaterZeroId, &ApproxZeroId
+    };
+    for (const UniqueId* classUid : classUids)
+    {
+        if (!exists(*classUid))
+        {
+            setupMetaModel();
+            break;
+        }
+    }
+
+    // The labels of the values are parsed only once
+    const Graph* graph(dynamic_cast<const Graph*>(&base));
+    if (graph)
+        realValues = graph->realValues;
+    double value;
+    for (const UniqueId& valueUid : instancesOf(Hyperedges{Graph::InterfaceValueId}))
+    {
+        if (!realValues.count(valueUid) && parseReal(access(valueUid).label(), value))
+            realValues[valueUid] = value;
+    }
+}
+
+Graph::Graph(const Prototype&)
 {
     setupMetaModel();
 }
 
+const Hypergraph& Graph::metaModel()
+{
+    // Creating the classes and interfaces of the meta model takes much longer than copying them
+    static const Graph prototype((Prototype()));
+    return prototype;
+}
+
 Graph::~Graph()
 {
 }
@@ -85,59 +191,59 @@ void Graph::setupMetaModel()
 
     // Built-in Algorithms (PURE BAGEL)
     // The different subclasses of MERGE
-    createAlgorithm("Behavior::Graph::Merge::Sum", "SUM", Hyperedges{Graph::MergeId});
-    createAlgorithm("Behavior::Graph::Merge::Product", "PRODUCT", Hyperedges{Graph::MergeId});
-    createAlgorithm("Behavior::Graph::Merge::Min", "MIN", Hyperedges{Graph::MergeId});
-    createAlgorithm("Behavior::Graph::Merge::Max", "MAX", Hyperedges{Graph::MergeId});
-    createAlgorithm("Behavior::Graph::Merge::Mean", "MEAN", Hyperedges{Graph::MergeId});
-    createAlgorithm("Behavior::Graph::Merge::Norm", "NORM", Hyperedges{Graph::MergeId});
+    createAlgorithm(Graph::SumId, "SUM", Hyperedges{Graph::MergeId});
+    createAlgorithm(Graph::ProductId, "PRODUCT", Hyperedges{Graph::MergeId});
+    createAlgorithm(Graph::MinId, "MIN", Hyperedges{Graph::MergeId});
+    createAlgorithm(Graph::MaxId, "MAX", Hyperedges{Graph::MergeId});
+    createAlgorithm(Graph::MeanId, "MEAN", Hyperedges{Graph::MergeId});
+    createAlgorithm(Graph::NormId, "NORM", Hyperedges{Graph::MergeId});
 
     // Arity 1 nodes
-    if (!exists("Behavior::Graph::Node::1-1"))
-    {
-        createAlgorithm("Behavior::Graph::Node::1-1", "NODE 1-1", Hyperedges{Graph::NodeId});
-        needsInterface(Hyperedges{"Behavior::Graph::Node::1-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::1-1"}, Hyperedges{Graph::InterfaceId}, "0"));
-        providesInterface(Hyperedges{"Behavior::Graph::Node::1-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::1-1"}, Hyperedges{Graph::InterfaceId}, "0"));
-    }
-    createAlgorithm("Behavior::Graph::Node::Pipe", "PIPE", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm(Graph::InputNodeId, "INPUT", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm(Graph::OutputNodeId, "OUTPUT", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::Divide", "DIVIDE", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::Sine", "SIN", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::Cosine", "COS", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::Tangens", "TAN", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::TangensHyperbolicus", "TANH", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::ArcusCosine", "ACOS", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::ArcusSine", "ASIN", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::ArcusTangens", "ATAN", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::Logarithm", "LOG", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::Exponential", "EXP", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::Absolute", "ABS", Hyperedges{"Behavior::Graph::Node::1-1"});
-    createAlgorithm("Behavior::Graph::Node::SquareRoot", "SQRT", Hyperedges{"Behavior::Graph::Node::1-1"});
+    if (!exists(Graph::Arity1Id))
+    {
+        createAlgorithm(Graph::Arity1Id, "NODE 1-1", Hyperedges{Graph::NodeId});
+        needsInterface(Hyperedges{Graph::Arity1Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity1Id}, Hyperedges{Graph::InterfaceId}, "0"));
+        providesInterface(Hyperedges{Graph::Arity1Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity1Id}, Hyperedges{Graph::InterfaceId}, "0"));
+    }
+    createAlgorithm(Graph::PipeId, "PIPE", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::InputNodeId, "INPUT", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::OutputNodeId, "OUTPUT", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::DivideId, "DIVIDE", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::SineId, "SIN", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::CosineId, "COS", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::TangensId, "TAN", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::TangensHyperbolicusId, "TANH", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::ArcusCosineId, "ACOS", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::ArcusSineId, "ASIN", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::ArcusTangensId, "ATAN", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::LogarithmId, "LOG", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::ExponentialId, "EXP", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::AbsoluteId, "ABS", Hyperedges{Graph::Arity1Id});
+    createAlgorithm(Graph::SquareRootId, "SQRT", Hyperedges{Graph::Arity1Id});
 
     // Arity 2 nodes
-    if (!exists("Behavior::Graph::Node::2-1"))
+    if (!exists(Graph::Arity2Id))
     {
-        createAlgorithm("Behavior::Graph::Node::2-1", "NODE 2-1", Hyperedges{Graph::NodeId});
-        needsInterface(Hyperedges{"Behavior::Graph::Node::2-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::2-1"}, Hyperedges{Graph::InterfaceId}, "0"));
-        needsInterface(Hyperedges{"Behavior::Graph::Node::2-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::2-1"}, Hyperedges{Graph::InterfaceId}, "1"));
-        providesInterface(Hyperedges{"Behavior::Graph::Node::2-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::2-1"}, Hyperedges{Graph::InterfaceId}, "0"));
+        createAlgorithm(Graph::Arity2Id, "NODE 2-1", Hyperedges{Graph::NodeId});
+        needsInterface(Hyperedges{Graph::Arity2Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity2Id}, Hyperedges{Graph::InterfaceId}, "0"));
+        needsInterface(Hyperedges{Graph::Arity2Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity2Id}, Hyperedges{Graph::InterfaceId}, "1"));
+        providesInterface(Hyperedges{Graph::Arity2Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity2Id}, Hyperedges{Graph::InterfaceId}, "0"));
     }
-    createAlgorithm("Behavior::Graph::Node::ArcusTangens2D", "ATAN2", Hyperedges{"Behavior::Graph::Node::2-1"});
-    createAlgorithm("Behavior::Graph::Node::Power", "POW", Hyperedges{"Behavior::Graph::Node::2-1"});
-    createAlgorithm("Behavior::Graph::Node::Modulo", "MOD", Hyperedges{"Behavior::Graph::Node::2-1"});
+    createAlgorithm(Graph::ArcusTangens2Id, "ATAN2", Hyperedges{Graph::Arity2Id});
+    createAlgorithm(Graph::PowerId, "POW", Hyperedges{Graph::Arity2Id});
+    createAlgorithm(Graph::ModuloId, "MOD", Hyperedges{Graph::Arity2Id});
 
     // Arity 3 nodes
-    if (!exists("Behavior::Graph::Node::3-1"))
+    if (!exists(Graph::Arity3Id))
     {
-        createAlgorithm("Behavior::Graph::Node::3-1", "NODE 3-1", Hyperedges{Graph::NodeId});
-        needsInterface(Hyperedges{"Behavior::Graph::Node::3-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::3-1"}, Hyperedges{Graph::InterfaceId}, "0"));
-        needsInterface(Hyperedges{"Behavior::Graph::Node::3-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::3-1"}, Hyperedges{Graph::InterfaceId}, "1"));
-        needsInterface(Hyperedges{"Behavior::Graph::Node::3-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::3-1"}, Hyperedges{Graph::InterfaceId}, "2"));
-        providesInterface(Hyperedges{"Behavior::Graph::Node::3-1"}, instantiateInterfaceFor(Hyperedges{"Behavior::Graph::Node::3-1"}, Hyperedges{Graph::InterfaceId}, "0"));
+        createAlgorithm(Graph::Arity3Id, "NODE 3-1", Hyperedges{Graph::NodeId});
+        needsInterface(Hyperedges{Graph::Arity3Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity3Id}, Hyperedges{Graph::InterfaceId}, "0"));
+        needsInterface(Hyperedges{Graph::Arity3Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity3Id}, Hyperedges{Graph::InterfaceId}, "1"));
+        needsInterface(Hyperedges{Graph::Arity3Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity3Id}, Hyperedges{Graph::InterfaceId}, "2"));
+        providesInterface(Hyperedges{Graph::Arity3Id}, instantiateInterfaceFor(Hyperedges{Graph::Arity3Id}, Hyperedges{Graph::InterfaceId}, "0"));
     }
-    createAlgorithm("Behavior::Graph::Node::GreaterZero", ">0", Hyperedges{"Behavior::Graph::Node::3-1"});
-    createAlgorithm("Behavior::Graph::Node::ApproxZero", "==0", Hyperedges{"Behavior::Graph::Node::3-1"});
+    createAlgorithm(Graph::GreaterZeroId, ">0", Hyperedges{Graph::Arity3Id});
+    createAlgorithm(Graph::ApproxZeroId, "==0", Hyperedges{Graph::Arity3Id});
 
     // Pregenerated entities (see Generator class in lib/componentnet)
     // TODO: Make two concrete interface classes (one for C++ and one for VHDL)
@@ -145,396 +251,1330 @@ void Graph::setupMetaModel()
     // TODO: Move to a BGRAPH Generator class
 }
 
+double Graph::realValueOf(const UniqueId& valueUid, const double fallback) const
+{
+    // The number of a destroyed value may still be known (see destroy)
+    if (!exists(valueUid))
+        return fallback;
+    std::unordered_map<UniqueId, double>::const_iterator it(realValues.find(valueUid));
+    if (it != realValues.end())
+        return it->second;
+    double value;
+    return parseReal(access(valueUid).label(), value) ? value : fallback;
+}
+
+void Graph::setRealValue(const UniqueId& valueUid, const double value)
+{
+    realValues[valueUid] = value;
+}
+
+void Graph::storeRealValues()
+{
+    std::unordered_map<UniqueId, double>::iterator it(realValues.begin());
+    while (it != realValues.end())
+    {
+        if (!exists(it->first))
+        {
+            it = realValues.erase(it);
+            continue;
+        }
+        access(it->first).updateLabel(formatReal(it->second));
+        ++it;
+    }
+}
+
+void Graph::destroy(const UniqueId& uid)
+{
+    realValues.erase(uid);
+    Software::Network::destroy(uid);
+}
+
+// Returns the values of the given interfaces as they are serialized
+static std::vector<std::string> valueLabelsOf(const Graph& graph, const Hyperedges& interfaceUids)
+{
+    std::vector<std::string> labels;
+    for (const UniqueId& valueUid : graph.valuesOf(interfaceUids))
+        labels.push_back(formatReal(graph.realValueOf(valueUid)));
+    return labels;
+}
+
 std::string Graph::exportModel(const UniqueId& uid) const
 {
-    YAML::Node doc;
-    doc["model"] = access(uid).label();
+    // Snapshot of the class memberships
+    Hyperedges partUids(componentsOf(Hyperedges{uid}));
+    const Hyperedges nodeInstances(instancesOf(algorithmClasses("",Hyperedges{Graph::NodeId})));
+    const Hyperedges externInstances(instancesOf(algorithmClasses("",Hyperedges{Graph::ExternId})));
+    const Hyperedges subgraphInstances(instancesOf(algorithmClasses("",Hyperedges{Graph::SubgraphId})));
+    const Hyperedges edgeInstances(instancesOf(algorithmClasses("",Hyperedges{Graph::EdgeId})));
+    const std::unordered_set<UniqueId> nodeUids(nodeInstances.begin(), nodeInstances.end());
+    const std::unordered_set<UniqueId> externNodeUids(externInstances.begin(), externInstances.end());
+    const std::unordered_set<UniqueId> subgraphNodeUids(subgraphInstances.begin(), subgraphInstances.end());
+    const std::unordered_set<UniqueId> edgeUids(edgeInstances.begin(), edgeInstances.end());
+
+    // The adjacency is recorded while the nodes are written, so the edges only have to look up their endpoints
+    // (node label, interface label) of every node output and of the node input fed by every MERGE
+    std::unordered_map< UniqueId, std::pair<std::string, std::string> > output2node;
+    std::unordered_map< UniqueId, std::pair<std::string, std::string> > mergeInput2node;
+
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "model" << YAML::Value << access(uid).label();
 
     // Handle nodes
-    Hyperedges partUids(componentsOf(Hyperedges{uid}));
-    Hyperedges nodeUids(instancesOf(algorithmClasses("",Hyperedges{Graph::NodeId})));
-    Hyperedges externNodeUids(instancesOf(algorithmClasses("",Hyperedges{Graph::ExternId})));
-    Hyperedges subgraphNodeUids(instancesOf(algorithmClasses("",Hyperedges{Graph::SubgraphId})));
-    for (const UniqueId& partUid : intersect(partUids, nodeUids))
-    {
-        YAML::Node node;
-        node["id"] = partUid;
-        node["name"] = access(partUid).label();
+    bool hasNodes(false);
+    for (const UniqueId& partUid : partUids)
+    {
+        if (!nodeUids.count(partUid))
+            continue;
+        const std::string& partLabel(access(partUid).label());
+
         // Handle inputs
-        Hyperedges partInputUids(inputsOf(Hyperedges{partUid}));
-        for (const UniqueId& partInputUid : partInputUids)
+        struct Input
+        {
+            std::string name;
+            std::string type;
+            std::string defaultValue;
+            std::string bias;
+        };
+        std::vector<Input> inputs;
+        for (const UniqueId& partInputUid : inputsOf(Hyperedges{partUid}))
         {
-            YAML::Node input;
-            input["name"] = access(partInputUid).label();
+            const std::string& inputLabel(access(partInputUid).label());
             // Handle merge
             Hyperedges mergeUids(outputsOf(endpointsOf(Hyperedges{partInputUid}, "out", TraversalDirection::INVERSE), "", TraversalDirection::INVERSE));
             for (const UniqueId& mergeUid : mergeUids)
             {
-                input["type"] = access(mergeUid).label();
-                Hyperedges defValueUids(valuesOf(inputsOf(Hyperedges{mergeUid}, "default")));
-                Hyperedges biasValueUids(valuesOf(inputsOf(Hyperedges{mergeUid}, "bias")));
-                for (const UniqueId& defValueUid : defValueUids)
+                Hyperedges defUids, biasUids;
+                for (const UniqueId& mergeInputUid : inputsOf(Hyperedges{mergeUid}))
                 {
-                    input["default"] = std::stof(access(defValueUid).label());
-                    for (const UniqueId& biasValueUid : biasValueUids)
-                    {
-                        input["bias"] = std::stof(access(biasValueUid).label());
-                        node["inputs"].push_back(input);
-                    }
+                    const std::string& label(access(mergeInputUid).label());
+                    if (label == "default")
+                        defUids.push_back(mergeInputUid);
+                    else if (label == "bias")
+                        biasUids.push_back(mergeInputUid);
+                    else if (label == "in")
+                        mergeInput2node[mergeInputUid] = std::make_pair(partLabel, inputLabel);
+                }
+                for (const std::string& defValue : valueLabelsOf(*this, defUids))
+                {
+                    for (const std::string& biasValue : valueLabelsOf(*this, biasUids))
+                        inputs.push_back(Input{inputLabel, access(mergeUid).label(), defValue, biasValue});
                 }
             }
         }
         // Handle outputs
-        Hyperedges partOutputUids(outputsOf(Hyperedges{partUid}));
-        for (const UniqueId& partOutputUid : partOutputUids)
+        std::vector<std::string> outputs;
+        for (const UniqueId& partOutputUid : outputsOf(Hyperedges{partUid}))
         {
-            YAML::Node output;
-            output["name"] = access(partOutputUid).label();
-            node["outputs"].push_back(output);
+            outputs.push_back(access(partOutputUid).label());
+            output2node[partOutputUid] = std::make_pair(partLabel, outputs.back());
         }
+
         // Handle node types
-        Hyperedges superclassUids(instancesOf(Hyperedges{partUid},"",TraversalDirection::FORWARD));
-        if (std::find(externNodeUids.begin(), externNodeUids.end(), partUid) != externNodeUids.end())
+        for (const UniqueId& superclassUid : instancesOf(Hyperedges{partUid},"",TraversalDirection::FORWARD))
         {
-            node["type"] = access(Graph::ExternId).label();
-            for (const UniqueId& superclassUid : superclassUids)
+            if (!hasNodes)
             {
-                node["extern_name"] = access(superclassUid).label();
-                doc["nodes"].push_back(node);
+                out << YAML::Key << "nodes" << YAML::Value << YAML::BeginSeq;
+                hasNodes = true;
             }
-        }
-        else if (std::find(subgraphNodeUids.begin(), subgraphNodeUids.end(), partUid) != subgraphNodeUids.end())
-        {
-            node["type"] = access(Graph::SubgraphId).label();
-            for (const UniqueId& superclassUid : superclassUids)
+            out << YAML::BeginMap;
+            out << YAML::Key << "id" << YAML::Value << partUid;
+            out << YAML::Key << "name" << YAML::Value << partLabel;
+            if (!inputs.empty())
             {
-                node["subgraph_name"] = access(superclassUid).label();
-                doc["nodes"].push_back(node);
+                out << YAML::Key << "inputs" << YAML::Value << YAML::BeginSeq;
+                for (const Input& input : inputs)
+                {
+                    out << YAML::BeginMap;
+                    out << YAML::Key << "name" << YAML::Value << input.name;
+                    out << YAML::Key << "type" << YAML::Value << input.type;
+                    out << YAML::Key << "default" << YAML::Value << input.defaultValue;
+                    out << YAML::Key << "bias" << YAML::Value << input.bias;
+                    out << YAML::EndMap;
+                }
+                out << YAML::EndSeq;
             }
-        }
-        else
-        {
-            for (const UniqueId& superclassUid : superclassUids)
+            if (!outputs.empty())
+            {
+                out << YAML::Key << "outputs" << YAML::Value << YAML::BeginSeq;
+                for (const std::string& output : outputs)
+                    out << YAML::BeginMap << YAML::Key << "name" << YAML::Value << output << YAML::EndMap;
+                out << YAML::EndSeq;
+            }
+            if (externNodeUids.count(partUid))
+            {
+                out << YAML::Key << "type" << YAML::Value << access(Graph::ExternId).label();
+                out << YAML::Key << "extern_name" << YAML::Value << access(superclassUid).label();
+            }
+            else if (subgraphNodeUids.count(partUid))
+            {
+                out << YAML::Key << "type" << YAML::Value << access(Graph::SubgraphId).label();
+                out << YAML::Key << "subgraph_name" << YAML::Value << access(superclassUid).label();
+            }
+            else
             {
-                node["type"] = access(superclassUid).label();
-                doc["nodes"].push_back(node);
+                out << YAML::Key << "type" << YAML::Value << access(superclassUid).label();
             }
+            out << YAML::EndMap;
         }
     }
+    if (hasNodes)
+        out << YAML::EndSeq;
 
     // Handle edges
-    Hyperedges edgeUids(instancesOf(algorithmClasses("",Hyperedges{Graph::EdgeId})));
-    for (const UniqueId& edgeUid : intersect(partUids, edgeUids))
+    bool hasEdges(false);
+    for (const UniqueId& edgeUid : partUids)
     {
-        YAML::Node edge;
+        if (!edgeUids.count(edgeUid))
+            continue;
         // weight, fromNode, toNode, fromNodeOutput, toNodeOutput
-        Hyperedges weightValueUids(valuesOf(inputsOf(Hyperedges{edgeUid}, "weight")));
-        Hyperedges predIfUids(endpointsOf(inputsOf(Hyperedges{edgeUid}, "in"),"",TraversalDirection::INVERSE));
-        Hyperedges succIfUids(endpointsOf(outputsOf(inputsOf(endpointsOf(outputsOf(Hyperedges{edgeUid}, "out")), "", TraversalDirection::INVERSE),"out")));
-        for (const UniqueId& weightValueUid : weightValueUids)
+        Hyperedges weightUids, inUids;
+        for (const UniqueId& edgeInputUid : inputsOf(Hyperedges{edgeUid}))
+        {
+            const std::string& label(access(edgeInputUid).label());
+            if (label == "weight")
+                weightUids.push_back(edgeInputUid);
+            else if (label == "in")
+                inUids.push_back(edgeInputUid);
+        }
+        Hyperedges predIfUids(endpointsOf(inUids,"",TraversalDirection::INVERSE));
+        Hyperedges mergeInputUids(endpointsOf(outputsOf(Hyperedges{edgeUid}, "out")));
+        for (const std::string& weight : valueLabelsOf(*this, weightUids))
         {
-            edge["weight"] = std::stof(access(weightValueUid).label());
             for (const UniqueId& predIfUid : predIfUids)
             {
-                edge["fromNodeOutput"] = access(predIfUid).label();
-                Hyperedges predNodeUids(outputsOf(Hyperedges{predIfUid}, "", TraversalDirection::INVERSE));
-                for (const UniqueId& predNodeUid : predNodeUids)
+                std::unordered_map< UniqueId, std::pair<std::string, std::string> >::const_iterator from(output2node.find(predIfUid));
+                if (from == output2node.end())
+                    continue;
+                for (const UniqueId& mergeInputUid : mergeInputUids)
                 {
-                    edge["fromNode"] = access(predNodeUid).label();
-                    for (const UniqueId& succIfUid : succIfUids)
+                    std::unordered_map< UniqueId, std::pair<std::string, std::string> >::const_iterator to(mergeInput2node.find(mergeInputUid));
+                    if (to == mergeInput2node.end())
+                        continue;
+                    if (!hasEdges)
                     {
-                        edge["toNodeInput"] = access(succIfUid).label();
-                        Hyperedges succNodeUids(inputsOf(Hyperedges{succIfUid}, "", TraversalDirection::INVERSE));
-                        for (const UniqueId& succNodeUid : succNodeUids)
-                        {
-                            edge["toNode"] = access(succNodeUid).label();
-                            doc["edges"].push_back(edge);
-                        }
+                        out << YAML::Key << "edges" << YAML::Value << YAML::BeginSeq;
+                        hasEdges = true;
                     }
+                    out << YAML::BeginMap;
+                    out << YAML::Key << "weight" << YAML::Value << weight;
+                    out << YAML::Key << "fromNodeOutput" << YAML::Value << from->second.second;
+                    out << YAML::Key << "fromNode" << YAML::Value << from->second.first;
+                    out << YAML::Key << "toNodeInput" << YAML::Value << to->second.second;
+                    out << YAML::Key << "toNode" << YAML::Value << to->second.first;
+                    out << YAML::EndMap;
                 }
             }
         }
     }
+    if (hasEdges)
+        out << YAML::EndSeq;
 
-    std::stringstream ss;
-    ss << doc;
-    return ss.str();
+    out << YAML::EndMap;
+    return out.c_str();
 }
 
-UniqueId Graph::importModel(const std::string& serializedModel)
+/*
+    Hash indexes used by importModel.
+    Looking up classes and interfaces by label searches the hypergraph, so doing it for every node, input and edge
+    made the import superlinear in the model size. The context queries every class hierarchy and every component only once
+    and is updated whenever the import creates classes, interfaces or merges.
+    All uids and labels are interned, so the indexes store every string once and hash integers.
+*/
+class ImportContext
 {
-    UniqueId modelUid;
-    YAML::Node doc = YAML::Load(serializedModel);
-    // Check if nodes exist. If not, reject model
-    const YAML::Node& nodesYAML(doc["nodes"]);
-    if (!nodesYAML.IsDefined())
-        return modelUid;
-    // Create SUBGRAPH class
-    std::string label("SUBGRAPH");
-    if (doc["model"].IsDefined())
-        label = doc["model"].as<std::string>();
-    modelUid = Graph::SubgraphId+"::"+label;
-    createAlgorithm(modelUid, label, Hyperedges{Graph::SubgraphId});
+    public:
+        ImportContext(Graph& graph)
+        : graph(graph)
+        {
+        }
 
-    // Handle nodes
-    std::map<UniqueId, Hyperedges> old2new;
-    std::map<std::string, Hyperedges> label2node;
-    for (YAML::Node::const_iterator nit = nodesYAML.begin(); nit != nodesYAML.end(); ++nit)
-    {
-        const YAML::Node& nodeYAML(*nit);
-        const UniqueId& id(nodeYAML["id"].as<UniqueId>());
-        const std::string& type(nodeYAML["type"].as<std::string>());
-        std::string label(id);
-        if (nodeYAML["name"].IsDefined())
-            label = nodeYAML["name"].as<std::string>();
-        // Find superclass of given name
-        Hyperedges superUids(algorithmClasses(type, Hyperedges{Graph::NodeId}));
-        if (superUids.empty())
+        // Same as algorithmClasses(label, Hyperedges{superUid})
+        Hyperedges classesOf(const UniqueId& superUid, const std::string& label)
         {
-            // TODO: This should be an error case?!
-            continue;
+            return find(classIndexOf(symbols.intern(superUid)), label);
         }
 
-        bool isExternNode(std::find(superUids.begin(), superUids.end(), Graph::ExternId) != superUids.end());
-        bool isSubgraphNode(std::find(superUids.begin(), superUids.end(), Graph::SubgraphId) != superUids.end());
-        if (isExternNode)
+        // Registers new classes which are subclasses of all the given superclasses
+        void addClasses(const Hyperedges& uids, const std::string& label, const Hyperedges& superUids)
         {
-            // Extern node
-            // extern_name defines the superclass!
-            const std::string& subtype(nodeYAML["extern_name"].as<std::string>());
-            superUids = algorithmClasses(subtype, Hyperedges{Graph::ExternId});
-            if (superUids.empty())
-                superUids = createAlgorithm(Graph::ExternId+"::"+subtype, subtype, Hyperedges{Graph::ExternId});
+            for (const UniqueId& superUid : superUids)
+            {
+                std::unordered_map<Symbol, LabelIndex>::iterator it(classes.find(symbols.intern(superUid)));
+                if (it != classes.end())
+                    add(it->second[symbols.intern(label)], uids);
+            }
         }
-        else if (isSubgraphNode)
+
+        // Same as inputsOf(uids, label) and outputsOf(uids, label)
+        Hyperedges inputsOf(const Hyperedges& uids, const std::string& label)
         {
-            // Subgraph node
-            // subgraph_name defines the superclass!
-            const std::string& subtype(nodeYAML["subgraph_name"].as<std::string>());
-            superUids = algorithmClasses(subtype, Hyperedges{Graph::SubgraphId});
-            if (superUids.empty())
-                superUids = createAlgorithm(Graph::SubgraphId+"::"+subtype, subtype, Hyperedges{Graph::SubgraphId});
+            Hyperedges result;
+            for (const UniqueId& uid : uids)
+                result = unite(result, find(interfaceIndexOf(inputs, symbols.intern(uid), true), label));
+            return result;
+        }
+        Hyperedges outputsOf(const Hyperedges& uids, const std::string& label)
+        {
+            Hyperedges result;
+            for (const UniqueId& uid : uids)
+                result = unite(result, find(interfaceIndexOf(outputs, symbols.intern(uid), false), label));
+            return result;
+        }
+
+        // Registers new interfaces of the given components
+        void addInputs(const Hyperedges& uids, const Hyperedges& interfaceUids, const std::string& label)
+        {
+            add(inputs, uids, interfaceUids, label);
+        }
+        void addOutputs(const Hyperedges& uids, const Hyperedges& interfaceUids, const std::string& label)
+        {
+            add(outputs, uids, interfaceUids, label);
         }
 
-        const YAML::Node& inputsYAML(nodeYAML["inputs"]);
-        const YAML::Node& outputsYAML(nodeYAML["outputs"]);
-        // Adding IO info to superclasses if needed
-        if (isExternNode || isSubgraphNode)
+        // The 'in' interfaces of the MERGEs connected to a node input (by MERGE type)
+        std::map<std::string, Hyperedges>& mergeInputsOf(const UniqueId& inputUid)
         {
-            // Create IOs (if they do not exist)
-            if (inputsYAML.IsDefined())
+            return mergeInputs[symbols.intern(inputUid)];
+        }
+
+        SymbolTable symbols;
+
+    private:
+        typedef std::unordered_map<Symbol, Symbols> LabelIndex;
+
+        Hyperedges find(const LabelIndex& index, const std::string& label) const
+        {
+            Hyperedges result;
+            LabelIndex::const_iterator it(index.find(symbols.find(label)));
+            if (it != index.end())
             {
-                for (YAML::Node::const_iterator it = inputsYAML.begin(); it != inputsYAML.end(); it++)
-                {
-                    const YAML::Node& inputYAML(*it);
-                    std::string inputLabel;
-                    if (inputYAML["name"].IsDefined())
-                    {
-                        inputLabel = inputYAML["name"].as<std::string>();
-                    } else {
-                        inputLabel = inputYAML["idx"].as<std::string>();
-                    }
-                    // Search for input
-                    Hyperedges inputOfComponent(inputsOf(superUids, inputLabel));
-                    if (inputOfComponent.size())
-                        continue;
-                    needsInterface(superUids, instantiateInterfaceFor(superUids, Hyperedges{Graph::InterfaceId}, inputLabel));
-                }
+                for (const Symbol uid : it->second)
+                    result.push_back(symbols.str(uid));
             }
-            if (outputsYAML.IsDefined())
+            return result;
+        }
+
+        // Appends the uids which are not in the list yet
+        void add(Symbols& list, const Hyperedges& uids)
+        {
+            for (const UniqueId& uid : uids)
             {
-                for (YAML::Node::const_iterator it = outputsYAML.begin(); it != outputsYAML.end(); it++)
-                {
-                    const YAML::Node& outputYAML(*it);
-                    std::string outputLabel;
-                    if (outputYAML["name"].IsDefined())
-                    {
-                        outputLabel = outputYAML["name"].as<std::string>();
-                    } else {
-                        outputLabel = outputYAML["idx"].as<std::string>();
-                    }
-                    // Search for output
-                    Hyperedges outputOfComponent(outputsOf(superUids, outputLabel));
-                    if (outputOfComponent.size())
-                        continue;
-                    providesInterface(superUids, instantiateInterfaceFor(superUids, Hyperedges{Graph::InterfaceId}, outputLabel));
-                }
+                const Symbol symbol(symbols.intern(uid));
+                if (std::find(list.begin(), list.end(), symbol) == list.end())
+                    list.push_back(symbol);
             }
         }
 
-        // Instantiate part
-        Hyperedges uid(instantiateComponent(superUids, label));
-        partOfComponent(uid, Hyperedges{modelUid});
-        old2new[id] = uid;
-        label2node[label] = uid;
+        LabelIndex& classIndexOf(const Symbol superUid)
+        {
+            std::unordered_map<Symbol, LabelIndex>::iterator it(classes.find(superUid));
+            if (it != classes.end())
+                return it->second;
+            LabelIndex& index(classes[superUid]);
+            for (const UniqueId& uid : graph.algorithmClasses("", Hyperedges{symbols.str(superUid)}))
+                index[symbols.intern(graph.access(uid).label())].push_back(symbols.intern(uid));
+            return index;
+        }
+
+        LabelIndex& interfaceIndexOf(std::unordered_map<Symbol, LabelIndex>& indexes, const Symbol uid, const bool isInput)
+        {
+            std::unordered_map<Symbol, LabelIndex>::iterator it(indexes.find(uid));
+            if (it != indexes.end())
+                return it->second;
+            LabelIndex& index(indexes[uid]);
+            const Hyperedges component{symbols.str(uid)};
+            for (const UniqueId& interfaceUid : (isInput ? graph.inputsOf(component) : graph.outputsOf(component)))
+                index[symbols.intern(graph.access(interfaceUid).label())].push_back(symbols.intern(interfaceUid));
+            return index;
+        }
+
+        // Indexes which have not been built yet will find the new interfaces anyway
+        void add(std::unordered_map<Symbol, LabelIndex>& indexes, const Hyperedges& uids, const Hyperedges& interfaceUids, const std::string& label)
+        {
+            for (const UniqueId& uid : uids)
+            {
+                std::unordered_map<Symbol, LabelIndex>::iterator it(indexes.find(symbols.intern(uid)));
+                if (it != indexes.end())
+                    add(it->second[symbols.intern(label)], interfaceUids);
+            }
+        }
+
+        Graph& graph;
+        std::unordered_map<Symbol, LabelIndex> classes;
+        std::unordered_map<Symbol, LabelIndex> inputs;
+        std::unordered_map<Symbol, LabelIndex> outputs;
+        std::unordered_map< Symbol, std::map<std::string, Hyperedges> > mergeInputs;
+};
+
+// Returns the label of an interface given by name or else by index
+static std::string interfaceLabelOf(const YAML::Node& interfaceYAML)
+{
+    if (interfaceYAML["name"].IsDefined())
+        return interfaceYAML["name"].as<std::string>();
+    return interfaceYAML["idx"].as<std::string>();
+}
+
+/*
+    Instantiates the nodes and edges of a model one at a time (see importModel).
+    Edges referring to nodes which have not been imported yet are kept until finish() is called.
+*/
+class ModelImporter
+{
+    public:
+        ModelImporter(Graph& graph)
+        : graph(graph),
+          context(graph)
+        {
+        }
+
+        // Creates the SUBGRAPH class of the model
+        void begin(const std::string& label)
+        {
+            modelUid = Graph::SubgraphId+"::"+label;
+            graph.createAlgorithm(modelUid, label, Hyperedges{Graph::SubgraphId});
+        }
+
+        void importNode(const YAML::Node& nodeYAML);
+
+        void importEdge(const YAML::Node& edgeYAML)
+        {
+            if (!connect(edgeYAML))
+                pendingEdges.push_back(YAML::Clone(edgeYAML));
+        }
+
+        // Imports the remaining edges and returns the uid of the model
+        UniqueId finish()
+        {
+            for (const YAML::Node& edgeYAML : pendingEdges)
+                connect(edgeYAML);
+            pendingEdges.clear();
+            return modelUid;
+        }
+
+    private:
+        // Returns false if one of the nodes does not exist (yet)
+        bool connect(const YAML::Node& edgeYAML);
+
+        Graph& graph;
+        ImportContext context;
+        UniqueId modelUid;
+        // Nodes by their id in the model and by their label (interned by the context)
+        std::unordered_map<Symbol, Hyperedges> old2new;
+        std::unordered_map<Symbol, Hyperedges> label2node;
+        std::vector<YAML::Node> pendingEdges;
+};
+
+void ModelImporter::importNode(const YAML::Node& nodeYAML)
+{
+    const UniqueId& id(nodeYAML["id"].as<UniqueId>());
+    const std::string& type(nodeYAML["type"].as<std::string>());
+    std::string label(id);
+    if (nodeYAML["name"].IsDefined())
+        label = nodeYAML["name"].as<std::string>();
+    // Find superclass of given name
+    Hyperedges superUids(context.classesOf(Graph::NodeId, type));
+    if (superUids.empty())
+    {
+        // TODO: This should be an error case?!
+        return;
+    }
+
+    bool isExternNode(std::find(superUids.begin(), superUids.end(), Graph::ExternId) != superUids.end());
+    bool isSubgraphNode(std::find(superUids.begin(), superUids.end(), Graph::SubgraphId) != superUids.end());
+    if (isExternNode)
+    {
+        // Extern node
+        // extern_name defines the superclass!
+        const std::string& subtype(nodeYAML["extern_name"].as<std::string>());
+        superUids = context.classesOf(Graph::ExternId, subtype);
+        if (superUids.empty())
+        {
+            superUids = graph.createAlgorithm(Graph::ExternId+"::"+subtype, subtype, Hyperedges{Graph::ExternId});
+            context.addClasses(superUids, subtype, Hyperedges{Graph::ExternId, Graph::NodeId});
+        }
+    }
+    else if (isSubgraphNode)
+    {
+        // Subgraph node
+        // subgraph_name defines the superclass!
+        const std::string& subtype(nodeYAML["subgraph_name"].as<std::string>());
+        superUids = context.classesOf(Graph::SubgraphId, subtype);
+        if (superUids.empty())
+        {
+            superUids = graph.createAlgorithm(Graph::SubgraphId+"::"+subtype, subtype, Hyperedges{Graph::SubgraphId});
+            context.addClasses(superUids, subtype, Hyperedges{Graph::SubgraphId, Graph::NodeId});
+        }
+    }
 
-        // Instantiate MERGE given IO info
+    const YAML::Node& inputsYAML(nodeYAML["inputs"]);
+    const YAML::Node& outputsYAML(nodeYAML["outputs"]);
+    // Adding IO info to superclasses if needed
+    if (isExternNode || isSubgraphNode)
+    {
+        // Create IOs (if they do not exist)
         if (inputsYAML.IsDefined())
         {
             for (YAML::Node::const_iterator it = inputsYAML.begin(); it != inputsYAML.end(); it++)
             {
-                const YAML::Node& inputYAML(*it);
-                std::string inputLabel;
-                if (inputYAML["name"].IsDefined())
-                {
-                    inputLabel = inputYAML["name"].as<std::string>();
-                } else {
-                    inputLabel = inputYAML["idx"].as<std::string>();
-                }
+                const std::string inputLabel(interfaceLabelOf(*it));
                 // Search for input
-                Hyperedges inputOfComponent(inputsOf(uid, inputLabel));
-                if (!inputOfComponent.size())
+                Hyperedges inputOfComponent(context.inputsOf(superUids, inputLabel));
+                if (inputOfComponent.size())
                     continue;
+                Hyperedges interfaceUids(graph.instantiateInterfaceFor(superUids, Hyperedges{Graph::InterfaceId}, inputLabel));
+                graph.needsInterface(superUids, interfaceUids);
+                context.addInputs(superUids, interfaceUids, inputLabel);
+            }
+        }
+        if (outputsYAML.IsDefined())
+        {
+            for (YAML::Node::const_iterator it = outputsYAML.begin(); it != outputsYAML.end(); it++)
+            {
+                const std::string outputLabel(interfaceLabelOf(*it));
+                // Search for output
+                Hyperedges outputOfComponent(context.outputsOf(superUids, outputLabel));
+                if (outputOfComponent.size())
+                    continue;
+                Hyperedges interfaceUids(graph.instantiateInterfaceFor(superUids, Hyperedges{Graph::InterfaceId}, outputLabel));
+                graph.providesInterface(superUids, interfaceUids);
+                context.addOutputs(superUids, interfaceUids, outputLabel);
+            }
+        }
+    }
+
+    // Instantiate part
+    Hyperedges uid(graph.instantiateComponent(superUids, label));
+    graph.partOfComponent(uid, Hyperedges{modelUid});
+    old2new[context.symbols.intern(id)] = uid;
+    label2node[context.symbols.intern(label)] = uid;
+
+    // Instantiate MERGE given IO info
+    if (inputsYAML.IsDefined())
+    {
+        for (YAML::Node::const_iterator it = inputsYAML.begin(); it != inputsYAML.end(); it++)
+        {
+            const YAML::Node& inputYAML(*it);
+            const std::string inputLabel(interfaceLabelOf(inputYAML));
+            // Search for input
+            Hyperedges inputOfComponent(context.inputsOf(uid, inputLabel));
+            if (!inputOfComponent.size())
+                continue;
 
-                // For INPUT nodes: Make their input(s) the input(s) of the toplvl node
-                // Also, suppress merge creation
-                bool isInputNode(std::find(superUids.begin(), superUids.end(), Graph::InputNodeId) != superUids.end());
-                if (isInputNode)
+            // For INPUT nodes: Make their input(s) the input(s) of the toplvl node
+            // Also, suppress merge creation
+            bool isInputNode(std::find(superUids.begin(), superUids.end(), Graph::InputNodeId) != superUids.end());
+            if (isInputNode)
+            {
+                for (const UniqueId& inputUid : inputOfComponent)
                 {
-                    for (const UniqueId& inputUid : inputOfComponent)
-                    {
-                        needsInterface(Hyperedges{modelUid}, instantiateAliasInterfaceFor(Hyperedges{modelUid}, Hyperedges{inputUid}, label));
-                    }
+                    graph.needsInterface(Hyperedges{modelUid}, graph.instantiateAliasInterfaceFor(Hyperedges{modelUid}, Hyperedges{inputUid}, label));
+                }
+                continue;
+            }
+
+            // For the found input, create and connect a merge (if it does not exist)
+            const std::string& mergeType(inputYAML["type"].as<std::string>());
+            double mergeBias(0.0), mergeDefault(0.0);
+            parseReal(inputYAML["bias"].as<std::string>(), mergeBias);
+            parseReal(inputYAML["default"].as<std::string>(), mergeDefault);
+            bool hasMerge(false);
+            for (const UniqueId& inputUid : inputOfComponent)
+                hasMerge |= context.mergeInputsOf(inputUid).count(mergeType) > 0;
+            if (!hasMerge)
+            {
+                Hyperedges mergeClassUids(context.classesOf(Graph::MergeId, mergeType));
+                if (mergeClassUids.empty())
                     continue;
+                Hyperedges newMergeUids(graph.instantiateComponent(mergeClassUids));
+                Hyperedges defValueUids(graph.valuesOf(context.inputsOf(newMergeUids, "default")));
+                for (const UniqueId& defValueUid : defValueUids)
+                {
+                    graph.setRealValue(defValueUid, mergeDefault);
                 }
-                
-                // For the found input, create and connect a merge (if it does not exist)
-                const std::string& mergeType(inputYAML["type"].as<std::string>());
-                const std::string& mergeBias(inputYAML["bias"].as<std::string>());
-                const std::string& mergeDefault(inputYAML["default"].as<std::string>());
-                Hyperedges mergeUids(outputsOf(endpointsOf(inputOfComponent, "out", TraversalDirection::INVERSE), mergeType, TraversalDirection::INVERSE));
-                if (mergeUids.empty())
+                Hyperedges biasValueUids(graph.valuesOf(context.inputsOf(newMergeUids, "bias")));
+                for (const UniqueId& biasValueUid : biasValueUids)
                 {
-                    Hyperedges mergeClassUids(algorithmClasses(mergeType, Hyperedges{Graph::MergeId}));
-                    if (mergeClassUids.empty())
-                        continue;
-                    Hyperedges newMergeUids(instantiateComponent(mergeClassUids));
-                    Hyperedges defValueUids(valuesOf(inputsOf(newMergeUids, "default")));
-                    for (const UniqueId& defValueUid : defValueUids)
-                    {
-                        access(defValueUid).updateLabel(mergeDefault);
-                    }
-                    Hyperedges biasValueUids(valuesOf(inputsOf(newMergeUids, "bias")));
-                    for (const UniqueId& biasValueUid : biasValueUids)
-                    {
-                        access(biasValueUid).updateLabel(mergeBias);
-                    }
-                    dependsOn(inputOfComponent, outputsOf(newMergeUids, "out"));
-                    partOfComponent(newMergeUids, Hyperedges{modelUid});
+                    graph.setRealValue(biasValueUid, mergeBias);
                 }
+                graph.dependsOn(inputOfComponent, context.outputsOf(newMergeUids, "out"));
+                graph.partOfComponent(newMergeUids, Hyperedges{modelUid});
+                for (const UniqueId& inputUid : inputOfComponent)
+                    context.mergeInputsOf(inputUid)[mergeType] = context.inputsOf(newMergeUids, "in");
             }
         }
+    }
 
-        // Export outputs
-        if (outputsYAML.IsDefined())
+    // Export outputs
+    if (outputsYAML.IsDefined())
+    {
+        for (YAML::Node::const_iterator it = outputsYAML.begin(); it != outputsYAML.end(); it++)
         {
-            for (YAML::Node::const_iterator it = outputsYAML.begin(); it != outputsYAML.end(); it++)
+            const std::string outputLabel(interfaceLabelOf(*it));
+            Hyperedges outputOfComponent(context.outputsOf(uid, outputLabel));
+            if (!outputOfComponent.size())
+                continue;
+
+            // For OUTPUT nodes: Make their output(s) the output(s) of the toplvl node
+            bool isOutputNode(std::find(superUids.begin(), superUids.end(), Graph::OutputNodeId) != superUids.end());
+            if (isOutputNode)
             {
-                const YAML::Node& outputYAML(*it);
-                std::string outputLabel;
-                if (outputYAML["name"].IsDefined())
+                for (const UniqueId& outputUid : outputOfComponent)
                 {
-                    outputLabel = outputYAML["name"].as<std::string>();
-                } else {
-                    outputLabel = outputYAML["idx"].as<std::string>();
+                    graph.providesInterface(Hyperedges{modelUid}, graph.instantiateAliasInterfaceFor(Hyperedges{modelUid}, Hyperedges{outputUid}, label));
                 }
-                Hyperedges outputOfComponent(outputsOf(uid, outputLabel));
-                if (!outputOfComponent.size())
-                    continue;
+            }
+        }
+    }
+}
 
-                // For OUTPUT nodes: Make their output(s) the output(s) of the toplvl node
-                bool isOutputNode(std::find(superUids.begin(), superUids.end(), Graph::OutputNodeId) != superUids.end());
-                if (isOutputNode)
+bool ModelImporter::connect(const YAML::Node& edgeYAML)
+{
+    double weight(1.0);
+    parseReal(edgeYAML["weight"].as<std::string>(), weight);
+    std::string fromLabel, fromOutputLabel, toLabel, toInputLabel;
+
+    // We can also connect by names, right? Yes :)
+    std::unordered_map<Symbol, Hyperedges>::const_iterator fromNode;
+    if (edgeYAML["fromNode"].IsDefined())
+    {
+        // Find UnqiueIds by label
+        fromLabel = edgeYAML["fromNode"].as<std::string>();
+        fromNode = label2node.find(context.symbols.find(fromLabel));
+        if (fromNode == label2node.end())
+            return false;
+    } else {
+        // Find UniqueIds by remapped ids
+        fromLabel = edgeYAML["fromNodeId"].as<std::string>();
+        fromNode = old2new.find(context.symbols.find(fromLabel));
+        if (fromNode == old2new.end())
+            return false;
+    }
+    std::unordered_map<Symbol, Hyperedges>::const_iterator toNode;
+    if (edgeYAML["toNode"].IsDefined())
+    {
+        // Find UnqiueIds by label
+        toLabel = edgeYAML["toNode"].as<std::string>();
+        toNode = label2node.find(context.symbols.find(toLabel));
+        if (toNode == label2node.end())
+            return false;
+    } else {
+        // Find UniqueIds by remapped ids
+        toLabel = edgeYAML["toNodeId"].as<std::string>();
+        toNode = old2new.find(context.symbols.find(toLabel));
+        if (toNode == old2new.end())
+            return false;
+    }
+    if (edgeYAML["fromNodeOutput"].IsDefined())
+    {
+        // Find UnqiueIds by label
+        fromOutputLabel = edgeYAML["fromNodeOutput"].as<std::string>();
+    } else {
+        // Find UniqueIds by remapped ids
+        fromOutputLabel = edgeYAML["fromNodeOutputIdx"].as<std::string>();
+    }
+    Hyperedges fromNodeOutputIds(context.outputsOf(fromNode->second, fromOutputLabel));
+    if (fromNodeOutputIds.empty())
+        return true;
+    if (edgeYAML["toNodeInput"].IsDefined())
+    {
+        // Find UnqiueIds by label
+        toInputLabel = edgeYAML["toNodeInput"].as<std::string>();
+    } else {
+        // Find UniqueIds by remapped ids
+        toInputLabel = edgeYAML["toNodeInputIdx"].as<std::string>();
+    }
+    Hyperedges toNodeInputIds(context.inputsOf(toNode->second, toInputLabel));
+    if (toNodeInputIds.empty())
+        return true;
+    // Get the merge node and their array input
+    Hyperedges mergeInputUids;
+    for (const UniqueId& toNodeInputId : toNodeInputIds)
+    {
+        for (const std::pair<const std::string, Hyperedges>& merge : context.mergeInputsOf(toNodeInputId))
+            mergeInputUids = unite(mergeInputUids, merge.second);
+    }
+    if (mergeInputUids.empty())
+        return true;
+
+    // Now we can instantiate and connect
+    Hyperedges uid(graph.instantiateComponent(Hyperedges{Graph::EdgeId}, fromLabel+"_"+fromOutputLabel+"_to_"+toLabel+"_"+toInputLabel));
+    graph.dependsOn(context.inputsOf(uid,"in"), fromNodeOutputIds);
+    graph.dependsOn(mergeInputUids, context.outputsOf(uid,"out"));
+    graph.partOfComponent(uid, Hyperedges{modelUid});
+
+    // Update weight value
+    Hyperedges weightValueUids(graph.valuesOf(context.inputsOf(uid, "weight")));
+    for (const UniqueId& weightValueUid : weightValueUids)
+    {
+        graph.setRealValue(weightValueUid, weight);
+    }
+    return true;
+}
+
+/*
+    A model as it has been read: The label, the entries of 'nodes' and 'edges' and whether there are nodes at all.
+    Nothing is created before the whole document has been parsed, so a malformed document leaves the graph untouched.
+*/
+struct ParsedModel
+{
+    ParsedModel()
+    : hasNodes(false),
+      hasLabel(false)
+    {
+    }
+
+    bool hasNodes;
+    bool hasLabel;
+    std::string label;
+    std::vector<YAML::Node> nodes;
+    std::vector<YAML::Node> edges;
+};
+
+/*
+    Turns the parser events of a model into a ParsedModel without building the whole document.
+    The entries of 'nodes' and 'edges' are built one at a time and all other values completely.
+    Anchored values are kept as well, so aliases resolve to them like in a loaded document.
+*/
+class ModelEventHandler : public YAML::EventHandler
+{
+    public:
+        ModelEventHandler(ParsedModel& model)
+        : model(model),
+          inDocument(false),
+          inEntries(false)
+        {
+        }
+
+        void OnDocumentStart(const YAML::Mark&) {}
+        void OnDocumentEnd() {}
+
+        void OnNull(const YAML::Mark&, YAML::anchor_t anchor)
+        {
+            remember(anchor, YAML::Node());
+            if (isBuilding() || inEntries || !key.empty())
+                add(YAML::Node());
+        }
+
+        void OnAlias(const YAML::Mark&, YAML::anchor_t anchor)
+        {
+            // Anchors of streamed values (e.g. the whole 'nodes' sequence) are not kept and yield null
+            std::unordered_map<YAML::anchor_t, YAML::Node>::const_iterator it(anchors.find(anchor));
+            const YAML::Node node(it != anchors.end() ? it->second : YAML::Node());
+            if (!isBuilding() && inDocument && !inEntries && key.empty())
+            {
+                key = node.as<std::string>("~");
+                return;
+            }
+            add(node);
+        }
+
+        void OnScalar(const YAML::Mark&, const std::string&, YAML::anchor_t anchor, const std::string& value)
+        {
+            remember(anchor, YAML::Node(value));
+            if (!isBuilding() && inDocument && !inEntries && key.empty())
+            {
+                key = value;
+                return;
+            }
+            add(YAML::Node(value));
+        }
+
+        void OnSequenceStart(const YAML::Mark&, const std::string&, YAML::anchor_t anchor, YAML::EmitterStyle::value)
+        {
+            if (!isBuilding() && inDocument && !inEntries && ((key == "nodes") || (key == "edges")))
+            {
+                // Build the entries one by one
+                inEntries = true;
+                if (key == "nodes")
+                    model.hasNodes = true;
+                return;
+            }
+            stack.push_back(YAML::Node(YAML::NodeType::Sequence));
+            keys.push_back(std::string());
+            stackAnchors.push_back(anchor);
+        }
+
+        void OnSequenceEnd()
+        {
+            if (!isBuilding())
+            {
+                inEntries = false;
+                key.clear();
+                return;
+            }
+            end();
+        }
+
+        void OnMapStart(const YAML::Mark&, const std::string&, YAML::anchor_t anchor, YAML::EmitterStyle::value)
+        {
+            if (!isBuilding() && !inDocument)
+            {
+                inDocument = true;
+                return;
+            }
+            stack.push_back(YAML::Node(YAML::NodeType::Map));
+            keys.push_back(std::string());
+            stackAnchors.push_back(anchor);
+        }
+
+        void OnMapEnd()
+        {
+            if (!isBuilding())
+            {
+                inDocument = false;
+                return;
+            }
+            end();
+        }
+
+    private:
+        bool isBuilding() const { return !stack.empty(); }
+
+        // Keeps an anchored value for later aliases
+        void remember(const YAML::anchor_t anchor, const YAML::Node& node)
+        {
+            if (anchor != YAML::NullAnchor)
+                anchors[anchor] = node;
+        }
+
+        // Closes the innermost sequence or map
+        void end()
+        {
+            YAML::Node node(stack.back());
+            remember(stackAnchors.back(), node);
+            stack.pop_back();
+            keys.pop_back();
+            stackAnchors.pop_back();
+            add(node);
+        }
+
+        // Adds a complete value to the innermost sequence or map or hands it over
+        void add(const YAML::Node& node)
+        {
+            if (isBuilding())
+            {
+                YAML::Node& parent(stack.back());
+                std::string& parentKey(keys.back());
+                if (parent.IsSequence())
                 {
-                    for (const UniqueId& outputUid : outputOfComponent)
-                    {
-                        providesInterface(Hyperedges{modelUid}, instantiateAliasInterfaceFor(Hyperedges{modelUid}, Hyperedges{outputUid}, label));
-                    }
+                    parent.push_back(node);
+                } else if (parentKey.empty()) {
+                    parentKey = node.as<std::string>("~");
+                } else {
+                    parent[parentKey] = node;
+                    parentKey.clear();
                 }
+                return;
+            }
+            if (inEntries)
+            {
+                if (key != "nodes")
+                    model.edges.push_back(node);
+                else
+                    model.nodes.push_back(node);
+                return;
+            }
+            // A value of the document
+            if ((key == "model") && node.IsScalar() && !model.hasLabel)
+            {
+                model.hasLabel = true;
+                model.label = node.as<std::string>();
+            }
+            else if (key == "nodes")
+            {
+                model.hasNodes = true;
             }
+            key.clear();
         }
+
+        ParsedModel& model;
+        bool inDocument;
+        bool inEntries;
+        std::string key;
+        // The sequences and maps being built (and their pending keys and anchors)
+        std::vector<YAML::Node> stack;
+        std::vector<std::string> keys;
+        std::vector<YAML::anchor_t> stackAnchors;
+        std::unordered_map<YAML::anchor_t, YAML::Node> anchors;
+};
+
+UniqueId Graph::importModel(const std::string& serializedModel)
+{
+    std::istringstream stream(serializedModel);
+    return importModel(stream);
+}
+
+// Reads a model without touching any graph, returns false if the document is malformed
+static bool parseModel(std::istream& stream, ParsedModel& model)
+{
+    ModelEventHandler handler(model);
+    try {
+        YAML::Parser parser(stream);
+        parser.HandleNextDocument(handler);
+    } catch (const YAML::Exception&) {
+        return false;
     }
+    return true;
+}
 
-    // Treat edges
-    const YAML::Node& edgesYAML(doc["edges"]);
-    if (!edgesYAML.IsDefined())
-        return modelUid;
+// Creates a model which has been read completely (the nodes first, so edges may refer to nodes which come later)
+static UniqueId importParsedModel(Graph& graph, const ParsedModel& model)
+{
+    if (!model.hasNodes)
+        return UniqueId();
+    ModelImporter importer(graph);
+    importer.begin(model.hasLabel ? model.label : std::string("SUBGRAPH"));
+    for (const YAML::Node& nodeYAML : model.nodes)
+        importer.importNode(nodeYAML);
+    for (const YAML::Node& edgeYAML : model.edges)
+        importer.importEdge(edgeYAML);
+    return importer.finish();
+}
 
-    for (YAML::Node::const_iterator eit = edgesYAML.begin(); eit != edgesYAML.end(); ++eit)
+UniqueId Graph::importModel(std::istream& stream)
+{
+    ParsedModel model;
+    if (!parseModel(stream, model))
+        return UniqueId();
+    return importParsedModel(*this, model);
+}
+
+// Calls work(i) for all i < count on up to 'threads' threads (the calling thread included)
+template<typename Work> static void parallelFor(const std::size_t count, const std::size_t threads, Work work)
+{
+    std::atomic<std::size_t> next(0);
+    auto worker = [&next, count, &work]() {
+        for (std::size_t i = next++; i < count; i = next++)
+            work(i);
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < std::min(threads, count); ++t)
+        workers.push_back(std::thread(worker));
+    worker();
+    for (std::thread& thread : workers)
+        thread.join();
+}
+
+Hyperedges Graph::importModels(const std::vector<std::string>& fileNames, const std::size_t threads)
+{
+    // Parse all files concurrently (unreadable and malformed files yield an empty uid)
+    const std::size_t n(fileNames.size());
+    std::vector<ParsedModel> models(n);
+    parallelFor(n, threads, [&fileNames, &models](const std::size_t i) {
+        std::ifstream fin(fileNames[i]);
+        if (!fin.good() || !parseModel(fin, models[i]))
+            models[i] = ParsedModel();
+    });
+
+    // A model depends on the models defining its SUBGRAPH nodes
+    std::map< std::string, std::vector<std::size_t> > modelsNamed;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (models[i].hasLabel)
+            modelsNamed[models[i].label].push_back(i);
+    }
+    std::vector< std::vector<std::size_t> > users(n);
+    std::vector<std::size_t> indegree(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
     {
-        const YAML::Node& edgeYAML(*eit);
-        const std::string& weight(edgeYAML["weight"].as<std::string>());
-        std::string fromLabel, fromOutputLabel, toLabel, toInputLabel;
+        std::set<std::size_t> dependencies;
+        for (const YAML::Node& nodeYAML : models[i].nodes)
+        {
+            if (!nodeYAML["subgraph_name"].IsDefined())
+                continue;
+            std::map< std::string, std::vector<std::size_t> >::const_iterator models(modelsNamed.find(nodeYAML["subgraph_name"].as<std::string>()));
+            if (models == modelsNamed.end())
+                continue;
+            for (const std::size_t j : models->second)
+            {
+                if ((j != i) && dependencies.insert(j).second)
+                {
+                    users[j].push_back(i);
+                    indegree[i]++;
+                }
+            }
+        }
+    }
 
-        // We can also connect by names, right? Yes :)
-        Hyperedges fromNodeIds;
-        if (edgeYAML["fromNode"].IsDefined())
+    // Import in dependency order (the first ready file first, so the result does not depend on the threads)
+    // NOTE: Models on a cycle of SUBGRAPH references are imported in the given order
+    Hyperedges result(n);
+    std::vector<bool> done(n, false);
+    std::set<std::size_t> ready;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!indegree[i])
+            ready.insert(i);
+    }
+    for (std::size_t imported = 0; imported < n; ++imported)
+    {
+        std::size_t i;
+        if (!ready.empty())
         {
-            // Find UnqiueIds by label
-            fromLabel = edgeYAML["fromNode"].as<std::string>();
-            fromNodeIds = label2node[fromLabel];
+            i = *ready.begin();
+            ready.erase(ready.begin());
         } else {
-            // Find UniqueIds by remapped ids
-            fromLabel = edgeYAML["fromNodeId"].as<std::string>();
-            fromNodeIds = old2new[fromLabel];
+            i = std::find(done.begin(), done.end(), false) - done.begin();
         }
-        if (fromNodeIds.empty())
-            continue;
-        Hyperedges toNodeIds;
-        if (edgeYAML["toNode"].IsDefined())
+        done[i] = true;
+        result[i] = importParsedModel(*this, models[i]);
+        models[i] = ParsedModel();
+        for (const std::size_t user : users[i])
         {
-            // Find UnqiueIds by label
-            toLabel = edgeYAML["toNode"].as<std::string>();
-            toNodeIds = label2node[toLabel];
-        } else {
-            // Find UniqueIds by remapped ids
-            toLabel = edgeYAML["toNodeId"].as<std::string>();
-            toNodeIds = old2new[toLabel];
+            if (!done[user] && !--indegree[user])
+                ready.insert(user);
         }
-        if (toNodeIds.empty())
-            continue;
-        if (edgeYAML["fromNodeOutput"].IsDefined())
+    }
+    return result;
+}
+
+std::vector<std::string> Graph::exportModels(const Hyperedges& uids, const std::size_t threads) const
+{
+    std::vector<std::string> result(uids.size());
+    parallelFor(uids.size(), threads, [this, &uids, &result](const std::size_t i) {
+        result[i] = exportModel(uids[i]);
+    });
+    return result;
+}
+
+// Maps the built-in NODE classes to their operations
+static const std::map<UniqueId, NodeOp>& builtinNodeOps()
+{
+    static const std::map<UniqueId, NodeOp> ops{
+        {Graph::PipeId, NodeOp::PIPE},
+        {Graph::InputNodeId, NodeOp::INPUT},
+        {Graph::OutputNodeId, NodeOp::OUTPUT},
+        {Graph::DivideId, NodeOp::DIVIDE},
+        {Graph::SineId, NodeOp::SIN},
+        {Graph::CosineId, NodeOp::COS},
+        {Graph::TangensId, NodeOp::TAN},
+        {Graph::TangensHyperbolicusId, NodeOp::TANH},
+        {Graph::ArcusCosineId, NodeOp::ACOS},
+        {Graph::ArcusSineId, NodeOp::ASIN},
+        {Graph::ArcusTangensId, NodeOp::ATAN},
+        {Graph::LogarithmId, NodeOp::LOG},
+        {Graph::ExponentialId, NodeOp::EXP},
+        {Graph::AbsoluteId, NodeOp::ABS},
+        {Graph::SquareRootId, NodeOp::SQRT},
+        {Graph::ArcusTangens2Id, NodeOp::ATAN2},
+        {Graph::PowerId, NodeOp::POW},
+        {Graph::ModuloId, NodeOp::MOD},
+        {Graph::GreaterZeroId, NodeOp::GREATER_ZERO},
+        {Graph::ApproxZeroId, NodeOp::APPROX_ZERO}
+    };
+    return ops;
+}
+
+// Maps the built-in MERGE classes to their operations
+static const std::map<UniqueId, MergeOp>& builtinMergeOps()
+{
+    static const std::map<UniqueId, MergeOp> ops{
+        {Graph::SumId, MergeOp::SUM},
+        {Graph::ProductId, MergeOp::PRODUCT},
+        {Graph::MinId, MergeOp::MIN},
+        {Graph::MaxId, MergeOp::MAX},
+        {Graph::MeanId, MergeOp::MEAN},
+        {Graph::NormId, MergeOp::NORM}
+    };
+    return ops;
+}
+
+// Returns the (first) value of the given interfaces
+static double interfaceValueOf(const Graph& graph, const Hyperedges& interfaceUids, const double fallback)
+{
+    for (const UniqueId& valueUid : graph.valuesOf(interfaceUids))
+        return graph.realValueOf(valueUid, fallback);
+    return fallback;
+}
+
+// Orders the interfaces of EXTERN nodes: indices (the idx of the YAML format) by value, then names alphabetically
+static bool isInterfaceBefore(const std::string& a, const std::string& b)
+{
+    const bool isIndexA(!a.empty() && (a.find_first_not_of("0123456789") == std::string::npos));
+    const bool isIndexB(!b.empty() && (b.find_first_not_of("0123456789") == std::string::npos));
+    if (isIndexA != isIndexB)
+        return isIndexA;
+    if (!isIndexA)
+        return a < b;
+    // Compare the digits without leading zeros (longer means larger)
+    const std::string digitsA(a.substr(std::min(a.find_first_not_of('0'), a.size() - 1)));
+    const std::string digitsB(b.substr(std::min(b.find_first_not_of('0'), b.size() - 1)));
+    if (digitsA.size() != digitsB.size())
+        return digitsA.size() < digitsB.size();
+    return digitsA < digitsB;
+}
+
+// Numbers the inputs or outputs of a SUBGRAPH or EXTERN node: the distinct labels in the order of their indices
+// NOTE: Graph::update numbers the outputs of an ADD_EDGE source the same way
+static std::vector<std::string> interfaceLabelsOf(const Graph& graph, const Hyperedges& interfaceUids, const bool isExtern)
+{
+    std::vector<std::string> labels;
+    for (const UniqueId& interfaceUid : interfaceUids)
+        labels.push_back(graph.access(interfaceUid).label());
+    if (isExtern)
+        std::sort(labels.begin(), labels.end(), isInterfaceBefore);
+    else
+        std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+    return labels;
+}
+
+Netlist Graph::lowerModel(const UniqueId& uid) const
+{
+    Netlist netlist;
+    if (!exists(uid))
+        return netlist;
+    netlist.name = access(uid).label();
+
+    Hyperedges partUids(componentsOf(Hyperedges{uid}));
+    Hyperedges nodeUids(intersect(partUids, instancesOf(algorithmClasses("",Hyperedges{Graph::NodeId}))));
+    Hyperedges edgeUids(intersect(partUids, instancesOf(algorithmClasses("",Hyperedges{Graph::EdgeId}))));
+    Hyperedges subgraphClassUids(subtract(algorithmClasses("",Hyperedges{Graph::SubgraphId}), Hyperedges{Graph::SubgraphId}));
+    Hyperedges externClassUids(subtract(algorithmClasses("",Hyperedges{Graph::ExternId}), Hyperedges{Graph::ExternId}));
+
+    // Handle nodes and their merges
+    std::map< UniqueId, std::pair<std::size_t, std::size_t> > output2node;
+    std::map< UniqueId, std::pair<std::size_t, std::size_t> > merge2input;
+    for (const UniqueId& nodeUid : nodeUids)
+    {
+        Netlist::Node node;
+        node.name = access(nodeUid).label();
+        node.uid = nodeUid;
+        bool isBuiltin(false);
+        for (const UniqueId& classUid : instancesOf(Hyperedges{nodeUid}, "", TraversalDirection::FORWARD))
         {
-            // Find UnqiueIds by label
-            fromOutputLabel = edgeYAML["fromNodeOutput"].as<std::string>();
-        } else {
-            // Find UniqueIds by remapped ids
-            fromOutputLabel = edgeYAML["fromNodeOutputIdx"].as<std::string>();
+            std::map<UniqueId, NodeOp>::const_iterator it(builtinNodeOps().find(classUid));
+            if (it == builtinNodeOps().end())
+                continue;
+            node.op = it->second;
+            node.classUid = classUid;
+            isBuiltin = true;
+            break;
         }
-        Hyperedges fromNodeOutputIds(outputsOf(fromNodeIds, fromOutputLabel));
-        if (fromNodeOutputIds.empty())
-            continue;
-        if (edgeYAML["toNodeInput"].IsDefined())
+        // SUBGRAPH and EXTERN nodes are kept together with their interfaces
+        std::vector<std::string> inputLabels;
+        std::vector<std::string> outputLabels;
+        if (!isBuiltin)
         {
-            // Find UnqiueIds by label
-            toInputLabel = edgeYAML["toNodeInput"].as<std::string>();
+            const Hyperedges superUids(instancesOf(Hyperedges{nodeUid}, "", TraversalDirection::FORWARD));
+            Hyperedges classUids(intersect(superUids, subgraphClassUids));
+            node.op = NodeOp::SUBGRAPH;
+            if (classUids.empty())
+            {
+                // The extern_name (label of the EXTERN class) selects the native function (see BehaviorExtern.hpp)
+                classUids = intersect(superUids, externClassUids);
+                if (classUids.empty())
+                    return Netlist();
+                node.op = NodeOp::EXTERN;
+                node.externName = access(*classUids.begin()).label();
+            }
+            node.classUid = *classUids.begin();
+            if (node.op == NodeOp::EXTERN)
+            {
+                // The native function gets every interface of the class (see BehaviorExtern.h), unconnected inputs yield their default
+                inputLabels = interfaceLabelsOf(*this, inputsOf(Hyperedges{node.classUid}), true);
+                outputLabels = interfaceLabelsOf(*this, outputsOf(Hyperedges{node.classUid}), true);
+            } else {
+                // Only the inputs having a merge have been declared for this instance
+                Hyperedges inputUids;
+                for (const UniqueId& inputUid : inputsOf(Hyperedges{nodeUid}))
+                {
+                    if (!endpointsOf(Hyperedges{inputUid}, "out", TraversalDirection::INVERSE).empty())
+                        inputUids.push_back(inputUid);
+                }
+                inputLabels = interfaceLabelsOf(*this, inputUids, false);
+                outputLabels = interfaceLabelsOf(*this, outputsOf(Hyperedges{nodeUid}), false);
+            }
         } else {
-            // Find UniqueIds by remapped ids
-            toInputLabel = edgeYAML["toNodeInputIdx"].as<std::string>();
+            for (std::size_t i = 0; i < arityOf(node.op); ++i)
+                inputLabels.push_back(std::to_string(i));
+            // Built-in nodes have exactly one output
+            outputLabels.push_back("0");
+        }
+
+        const std::size_t nodeIdx(netlist.nodes.size());
+        for (std::size_t i = 0; i < inputLabels.size(); ++i)
+        {
+            const std::string& inputLabel(inputLabels[i]);
+            // Unconnected inputs behave like a merge without edges
+            Netlist::Merge merge{MergeOp::SUM, 0.0, 0.0, std::vector<Netlist::Edge>(), ""};
+            Hyperedges mergeUids(outputsOf(endpointsOf(inputsOf(Hyperedges{nodeUid}, inputLabel), "out", TraversalDirection::INVERSE), "", TraversalDirection::INVERSE));
+            for (const UniqueId& mergeUid : mergeUids)
+            {
+                bool isBuiltinMerge(false);
+                for (const UniqueId& classUid : instancesOf(Hyperedges{mergeUid}, "", TraversalDirection::FORWARD))
+                {
+                    std::map<UniqueId, MergeOp>::const_iterator it(builtinMergeOps().find(classUid));
+                    if (it == builtinMergeOps().end())
+                        continue;
+                    merge.op = it->second;
+                    isBuiltinMerge = true;
+                    break;
+                }
+                if (!isBuiltinMerge)
+                    return Netlist();
+                merge.uid = mergeUid;
+                merge.bias = interfaceValueOf(*this, inputsOf(Hyperedges{mergeUid}, "bias"), 0.0);
+                merge.defaultValue = interfaceValueOf(*this, inputsOf(Hyperedges{mergeUid}, "default"), 0.0);
+                merge2input[mergeUid] = std::make_pair(nodeIdx, i);
+                break;
+            }
+            node.inputNames.push_back(inputLabel);
+            node.inputs.push_back(merge);
         }
-        Hyperedges toNodeInputIds(inputsOf(toNodeIds, toInputLabel));
-        if (toNodeInputIds.empty())
-            continue;
-        // Get the merge node and their array input
-        Hyperedges mergeInputUids(inputsOf(outputsOf(endpointsOf(toNodeInputIds, "out", TraversalDirection::INVERSE),"",TraversalDirection::INVERSE), "in"));
-        if (mergeInputUids.empty())
-            continue;
 
-        // Now we can instantiate and connect
-        Hyperedges uid(instantiateComponent(Hyperedges{Graph::EdgeId}, fromLabel+"_"+fromOutputLabel+"_to_"+toLabel+"_"+toInputLabel));
-        dependsOn(inputsOf(uid,"in"), fromNodeOutputIds);
-        dependsOn(mergeInputUids, outputsOf(uid,"out"));
-        partOfComponent(uid, Hyperedges{modelUid});
+        for (std::size_t o = 0; o < outputLabels.size(); ++o)
+        {
+            node.outputNames.push_back(outputLabels[o]);
+            for (const UniqueId& outputUid : outputsOf(Hyperedges{nodeUid}, outputLabels[o]))
+                output2node[outputUid] = std::make_pair(nodeIdx, o);
+        }
+        netlist.nodes.push_back(node);
+    }
 
-        // Update weight value
-        Hyperedges weightValueUids(valuesOf(inputsOf(uid, "weight")));
-        for (const UniqueId weightValueUid : weightValueUids)
+    // Handle edges
+    for (const UniqueId& edgeUid : edgeUids)
+    {
+        const double weight(interfaceValueOf(*this, inputsOf(Hyperedges{edgeUid}, "weight"), 1.0));
+        Hyperedges predIfUids(endpointsOf(inputsOf(Hyperedges{edgeUid}, "in"),"",TraversalDirection::INVERSE));
+        Hyperedges mergeUids(inputsOf(endpointsOf(outputsOf(Hyperedges{edgeUid}, "out")), "", TraversalDirection::INVERSE));
+        for (const UniqueId& predIfUid : predIfUids)
+        {
+            std::map< UniqueId, std::pair<std::size_t, std::size_t> >::const_iterator from(output2node.find(predIfUid));
+            if (from == output2node.end())
+                continue;
+            for (const UniqueId& mergeUid : mergeUids)
+            {
+                std::map< UniqueId, std::pair<std::size_t, std::size_t> >::const_iterator to(merge2input.find(mergeUid));
+                if (to == merge2input.end())
+                    continue;
+                Netlist::Edge edge{from->second.first, from->second.second, weight, edgeUid, false};
+                netlist.nodes[to->second.first].inputs[to->second.second].edges.push_back(edge);
+            }
+        }
+    }
+
+    return netlist;
+}
+
+// Flattens a SUBGRAPH (class) bottom up, the active SUBGRAPHs are tracked to reject recursive ones
+static Netlist flattenRecursively(const Graph& graph, const UniqueId& uid, std::map<UniqueId, Netlist>& cache, std::set<UniqueId>& active)
+{
+    std::map<UniqueId, Netlist>::const_iterator cached(cache.find(uid));
+    if (cached != cache.end())
+        return cached->second;
+    if (active.count(uid))
+        return Netlist();
+
+    Netlist netlist(graph.lowerModel(uid));
+    std::vector<const Netlist*> bodies(netlist.nodes.size(), NULL);
+    bool hasSubgraphs(false);
+    active.insert(uid);
+    for (std::size_t i = 0; i < netlist.nodes.size(); ++i)
+    {
+        const Netlist::Node& node(netlist.nodes[i]);
+        if (node.op != NodeOp::SUBGRAPH)
+            continue;
+        // The cache also stores the bodies (the map does not invalidate pointers)
+        if (!cache.count(node.classUid))
         {
-            access(weightValueUid).updateLabel(weight);
+            Netlist body(flattenRecursively(graph, node.classUid, cache, active));
+            if (body.empty())
+            {
+                active.erase(uid);
+                return Netlist();
+            }
+            cache[node.classUid] = body;
         }
+        bodies[i] = &cache[node.classUid];
+        hasSubgraphs = true;
     }
+    active.erase(uid);
 
-    return modelUid;
+    if (hasSubgraphs)
+        netlist = inlineSubgraphs(netlist, bodies);
+    removePipes(netlist);
+    return netlist;
+}
+
+Netlist Graph::flattenModel(const UniqueId& uid, std::map<UniqueId, Netlist>* cache) const
+{
+    std::map<UniqueId, Netlist> bodies;
+    std::set<UniqueId> active;
+    Netlist netlist(flattenRecursively(*this, uid, cache ? *cache : bodies, active));
+    if (cache && !netlist.empty())
+        (*cache)[uid] = netlist;
+    return netlist;
+}
+
+Program Graph::compileModel(const UniqueId& uid, const Precision precision, const Feedback feedback) const
+{
+    return Program(flattenModel(uid), precision, feedback);
+}
+
+// Sets the values of the given interfaces
+static void setInterfaceValue(Graph& graph, const Hyperedges& interfaceUids, const double value)
+{
+    for (const UniqueId& valueUid : graph.valuesOf(interfaceUids))
+        graph.setRealValue(valueUid, value);
+}
+
+bool Graph::update(Updates& updates)
+{
+    for (Update& change : updates)
+    {
+        switch (change.kind)
+        {
+            case Update::Kind::WEIGHT:
+            case Update::Kind::BIAS:
+            case Update::Kind::DEFAULT:
+            {
+                const std::string label(change.kind == Update::Kind::WEIGHT ? "weight" : (change.kind == Update::Kind::BIAS ? "bias" : "default"));
+                const Hyperedges interfaceUids(exists(change.uid) ? inputsOf(Hyperedges{change.uid}, label) : Hyperedges());
+                if (interfaceUids.empty())
+                    return false;
+                setInterfaceValue(*this, interfaceUids, change.value);
+                break;
+            }
+            case Update::Kind::ADD_EDGE:
+            {
+                if (!exists(change.uid) || !exists(change.source))
+                    return false;
+                const Hyperedges mergeInputUids(inputsOf(Hyperedges{change.uid}, "in"));
+                // Outputs are numbered as in lowerModel (EXTERN nodes by the interfaces of their class)
+                const Hyperedges externClassUids(intersect(instancesOf(Hyperedges{change.source}, "", TraversalDirection::FORWARD),
+                                                           subtract(algorithmClasses("",Hyperedges{Graph::ExternId}), Hyperedges{Graph::ExternId})));
+                const std::vector<std::string> outputLabels(externClassUids.empty() ?
+                                                            interfaceLabelsOf(*this, outputsOf(Hyperedges{change.source}), false) :
+                                                            interfaceLabelsOf(*this, outputsOf(Hyperedges{*externClassUids.begin()}), true));
+                if (mergeInputUids.empty() || (change.output >= outputLabels.size()))
+                    return false;
+                const std::string& outputLabel(outputLabels[change.output]);
+                Hyperedges uid(instantiateComponent(Hyperedges{Graph::EdgeId}, access(change.source).label()+"_"+outputLabel+"_to_"+access(change.uid).label()));
+                dependsOn(inputsOf(uid, "in"), outputsOf(Hyperedges{change.source}, outputLabel));
+                dependsOn(mergeInputUids, outputsOf(uid, "out"));
+                partOfComponent(uid, componentsOf(Hyperedges{change.uid}, "", TraversalDirection::FORWARD));
+                setInterfaceValue(*this, inputsOf(uid, "weight"), change.value);
+                change.edge = *uid.begin();
+                break;
+            }
+            case Update::Kind::REMOVE_EDGE:
+            {
+                if (!exists(change.uid) || inputsOf(Hyperedges{change.uid}, "weight").empty())
+                    return false;
+                const Hyperedges interfaceUids(unite(inputsOf(Hyperedges{change.uid}), outputsOf(Hyperedges{change.uid})));
+                for (const UniqueId& valueUid : valuesOf(interfaceUids))
+                    destroy(valueUid);
+                for (const UniqueId& interfaceUid : interfaceUids)
+                    destroy(interfaceUid);
+                destroy(change.uid);
+                break;
+            }
+        }
+    }
+    return true;
 }
 
 //std::string Graph::floatToStdLogicVector(const float value)
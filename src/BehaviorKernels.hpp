@@ -0,0 +1,389 @@
+#ifndef _BEHAVIOUR_KERNELS_HPP
+#define _BEHAVIOUR_KERNELS_HPP
+
+#include "BehaviorProgram.hpp"
+#include "BehaviorLayers.hpp"
+#include "BehaviorSimd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Behavior {
+
+// Computes the output of a built-in node given its merged inputs
+// NOTE: INPUT, EXTERN and SUBGRAPH nodes are not handled here
+template<Precision P> inline double applyNodeWith(const NodeOp op, const double* in)
+{
+    switch (op)
+    {
+        case NodeOp::PIPE:
+        case NodeOp::OUTPUT:
+            return in[0];
+        case NodeOp::DIVIDE:
+            return 1.0 / in[0];
+        case NodeOp::SIN:
+            return FastMath::sin<P>(in[0]);
+        case NodeOp::COS:
+            return FastMath::cos<P>(in[0]);
+        case NodeOp::TAN:
+            return std::tan(in[0]);
+        case NodeOp::TANH:
+            return FastMath::tanh<P>(in[0]);
+        case NodeOp::ACOS:
+            return std::acos(in[0]);
+        case NodeOp::ASIN:
+            return std::asin(in[0]);
+        case NodeOp::ATAN:
+            return FastMath::atan<P>(in[0]);
+        case NodeOp::LOG:
+            return FastMath::log<P>(in[0]);
+        case NodeOp::EXP:
+            return FastMath::exp<P>(in[0]);
+        case NodeOp::ABS:
+            return std::fabs(in[0]);
+        case NodeOp::SQRT:
+            return std::sqrt(in[0]);
+        case NodeOp::ATAN2:
+            return FastMath::atan2<P>(in[0], in[1]);
+        case NodeOp::POW:
+            return FastMath::pow<P>(in[0], in[1]);
+        case NodeOp::MOD:
+            return std::fmod(in[0], in[1]);
+        case NodeOp::GREATER_ZERO:
+            return in[0] > 0.0 ? in[1] : in[2];
+        case NodeOp::APPROX_ZERO:
+            return std::fabs(in[0]) < ApproxZeroEpsilon ? in[1] : in[2];
+        default:
+            return 0.0;
+    }
+}
+
+inline double applyNode(const NodeOp op, const double* in, const Precision precision)
+{
+    switch (precision)
+    {
+        case Precision::HIGH:
+            return applyNodeWith<Precision::HIGH>(op, in);
+        case Precision::LOW:
+            return applyNodeWith<Precision::LOW>(op, in);
+        default:
+            return applyNodeWith<Precision::EXACT>(op, in);
+    }
+}
+
+// Computes the output of a merge given its incoming edges
+// Unconnected merges yield their default value, all others 'bias + op(weight * value)'
+inline double applyMerge(const MergeOp op, const double bias, const double defaultValue,
+                         const std::uint32_t* sources, const double* weights, const std::size_t n,
+                         const double* values)
+{
+    if (!n)
+        return defaultValue;
+
+    // The first edge initializes the accumulator
+    double result(weights[0] * values[sources[0]]);
+    switch (op)
+    {
+        case MergeOp::SUM:
+        case MergeOp::MEAN:
+            for (std::size_t e = 1; e < n; ++e)
+                result += weights[e] * values[sources[e]];
+            if (op == MergeOp::MEAN)
+                result /= n;
+            break;
+        case MergeOp::PRODUCT:
+            for (std::size_t e = 1; e < n; ++e)
+                result *= weights[e] * values[sources[e]];
+            break;
+        case MergeOp::MIN:
+            for (std::size_t e = 1; e < n; ++e)
+                result = std::min(result, weights[e] * values[sources[e]]);
+            break;
+        case MergeOp::MAX:
+            for (std::size_t e = 1; e < n; ++e)
+                result = std::max(result, weights[e] * values[sources[e]]);
+            break;
+        case MergeOp::NORM:
+            result *= result;
+            for (std::size_t e = 1; e < n; ++e)
+            {
+                const double x(weights[e] * values[sources[e]]);
+                result += x * x;
+            }
+            result = std::sqrt(result);
+            break;
+    }
+    return result + bias;
+}
+
+/*
+    Batch kernels
+    They operate on 'lanes' independent instances at once. Every value is stored lane-wise,
+    so the i-th input of a node is found at in[i * lanes + lane].
+*/
+
+// Computes the outputs of a built-in node for all lanes
+inline void applyNodeBatch(const NodeOp op, const double* in, const std::size_t lanes, double* out, const Precision precision)
+{
+    const double* in0(in);
+    const double* in1(in + lanes);
+    const double* in2(in + 2 * lanes);
+    switch (op)
+    {
+        case NodeOp::PIPE:
+        case NodeOp::OUTPUT:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = in0[l];
+            break;
+        case NodeOp::DIVIDE:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = 1.0 / in0[l];
+            break;
+        case NodeOp::SIN:
+            FastMath::sin(in0, out, lanes, precision);
+            break;
+        case NodeOp::COS:
+            FastMath::cos(in0, out, lanes, precision);
+            break;
+        case NodeOp::TAN:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::tan(in0[l]);
+            break;
+        case NodeOp::TANH:
+            FastMath::tanh(in0, out, lanes, precision);
+            break;
+        case NodeOp::ACOS:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::acos(in0[l]);
+            break;
+        case NodeOp::ASIN:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::asin(in0[l]);
+            break;
+        case NodeOp::ATAN:
+            FastMath::atan(in0, out, lanes, precision);
+            break;
+        case NodeOp::LOG:
+            FastMath::log(in0, out, lanes, precision);
+            break;
+        case NodeOp::EXP:
+            FastMath::exp(in0, out, lanes, precision);
+            break;
+        case NodeOp::ABS:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::fabs(in0[l]);
+            break;
+        case NodeOp::SQRT:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::sqrt(in0[l]);
+            break;
+        case NodeOp::ATAN2:
+            FastMath::atan2(in0, in1, out, lanes, precision);
+            break;
+        case NodeOp::POW:
+            FastMath::pow(in0, in1, out, lanes, precision);
+            break;
+        case NodeOp::MOD:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::fmod(in0[l], in1[l]);
+            break;
+        case NodeOp::GREATER_ZERO:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = in0[l] > 0.0 ? in1[l] : in2[l];
+            break;
+        case NodeOp::APPROX_ZERO:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::fabs(in0[l]) < ApproxZeroEpsilon ? in1[l] : in2[l];
+            break;
+        default:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = 0.0;
+            break;
+    }
+}
+
+// Computes the output of a merge for all lanes
+// The lanes of edge e are read from values + sources[e] * sourceStride
+inline void applyMergeBatch(const MergeOp op, const double bias, const double defaultValue,
+                            const std::uint32_t* sources, const double* weights, const std::size_t n,
+                            const double* values, const std::size_t sourceStride, const std::size_t lanes, double* out)
+{
+    if (!n)
+    {
+        for (std::size_t l = 0; l < lanes; ++l)
+            out[l] = defaultValue;
+        return;
+    }
+
+    // The first edge initializes the accumulator
+    const double* x0(values + sources[0] * sourceStride);
+    const double w0(weights[0]);
+    switch (op)
+    {
+        case MergeOp::NORM:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = (w0 * x0[l]) * (w0 * x0[l]);
+            break;
+        default:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = w0 * x0[l];
+            break;
+    }
+
+    for (std::size_t e = 1; e < n; ++e)
+    {
+        const double* x(values + sources[e] * sourceStride);
+        const double w(weights[e]);
+        switch (op)
+        {
+            case MergeOp::SUM:
+            case MergeOp::MEAN:
+                for (std::size_t l = 0; l < lanes; ++l)
+                    out[l] += w * x[l];
+                break;
+            case MergeOp::PRODUCT:
+                for (std::size_t l = 0; l < lanes; ++l)
+                    out[l] *= w * x[l];
+                break;
+            case MergeOp::MIN:
+                for (std::size_t l = 0; l < lanes; ++l)
+                    out[l] = std::min(out[l], w * x[l]);
+                break;
+            case MergeOp::MAX:
+                for (std::size_t l = 0; l < lanes; ++l)
+                    out[l] = std::max(out[l], w * x[l]);
+                break;
+            case MergeOp::NORM:
+                for (std::size_t l = 0; l < lanes; ++l)
+                    out[l] += (w * x[l]) * (w * x[l]);
+                break;
+        }
+    }
+
+    switch (op)
+    {
+        case MergeOp::MEAN:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = out[l] / n + bias;
+            break;
+        case MergeOp::NORM:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] = std::sqrt(out[l]) + bias;
+            break;
+        default:
+            for (std::size_t l = 0; l < lanes; ++l)
+                out[l] += bias;
+            break;
+    }
+}
+
+// Calls the native function of EXTERN node n for all lanes (see BehaviorExtern.h), unbound nodes yield zeros
+// Input i of lane l is read from in[i * inputStride + l], output o is written to out[o * outputStride + l]
+inline void applyExtern(const Program& prog, const std::size_t n, const double* in, const std::size_t inputStride,
+                        double* out, const std::size_t outputStride, const std::size_t lanes)
+{
+    const ExternBinding& binding(prog.externBindings[prog.nodePort[n]]);
+    const std::size_t numOutputs(prog.nodeSlotBegin[n+1] - prog.nodeSlotBegin[n]);
+    if (!binding.function)
+    {
+        for (std::size_t o = 0; o < numOutputs; ++o)
+            std::fill(out + o * outputStride, out + o * outputStride + lanes, 0.0);
+        return;
+    }
+    const BehaviorExternCall call = {in, inputStride, prog.nodeMergeBegin[n+1] - prog.nodeMergeBegin[n], out, outputStride, numOutputs, lanes};
+    binding.function(binding.context, &call);
+}
+
+// Computes the merges of node n (see evaluateNodes)
+inline void evaluateMerges(const Program& prog, const std::size_t n, const MergeKernel mergeKernel,
+                           const std::uint32_t* edgeSource, const double* v, double* m)
+{
+    const double* edgeWeight(prog.edgeWeight.data());
+    const std::uint32_t mergeBegin(prog.nodeMergeBegin[n]);
+    const std::uint32_t mergeEnd(prog.nodeMergeBegin[n+1]);
+    for (std::uint32_t k = mergeBegin; k < mergeEnd; ++k)
+    {
+        const std::uint32_t edgeBegin(prog.mergeEdgeBegin[k]);
+        const std::uint32_t edgeCount(prog.mergeEdgeBegin[k+1] - edgeBegin);
+        if (edgeCount < SimdMergeThreshold)
+            m[k] = applyMerge(prog.mergeOps[k], prog.mergeBias[k], prog.mergeDefault[k],
+                              edgeSource + edgeBegin, edgeWeight + edgeBegin, edgeCount,
+                              v);
+        else
+            m[k] = mergeKernel(prog.mergeOps[k], prog.mergeBias[k], prog.mergeDefault[k],
+                               edgeSource + edgeBegin, edgeWeight + edgeBegin, edgeCount,
+                               v);
+    }
+}
+
+// Computes node n from its merges (see evaluateNodes)
+inline void evaluateNode(const Program& prog, const std::size_t n, const double* inputs, double* out, const double* m)
+{
+    const NodeOp op(prog.nodeOps[n]);
+    if (op == NodeOp::INPUT)
+        out[prog.nodeSlotBegin[n]] = inputs[prog.nodePort[n]];
+    else if (op == NodeOp::EXTERN)
+        applyExtern(prog, n, m + prog.nodeMergeBegin[n], 1, out + prog.nodeSlotBegin[n], 1, 1);
+    else
+        out[prog.nodeSlotBegin[n]] = applyNode(op, m + prog.nodeMergeBegin[n], prog.precision);
+}
+
+// Evaluates the nodes [begin, end) of a program: first their merges, then the nodes themselves
+// The edges read the values v at edgeSource (see Program::sourcesOf), the nodes write their values to out
+inline void evaluateNodes(const Program& prog, const std::size_t begin, const std::size_t end,
+                          const MergeKernel mergeKernel, const std::uint32_t* edgeSource,
+                          const double* inputs, const double* v, double* out, double* m)
+{
+    for (std::size_t n = begin; n < end; ++n)
+    {
+        evaluateMerges(prog, n, mergeKernel, edgeSource, v, m);
+        evaluateNode(prog, n, inputs, out, m);
+    }
+}
+
+// Tells whether none of the values is infinite or NaN (compares the exponent bits, so the loop vectorizes)
+inline bool allFinite(const double* v, const std::size_t n)
+{
+    const std::uint64_t exponent(0x7ff0000000000000ull);
+    std::uint64_t nonFinite(0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, v + i, sizeof(bits));
+        nonFinite |= ((bits & exponent) == exponent);
+    }
+    return !nonFinite;
+}
+
+// Evaluates the nodes of a layer (see BehaviorLayers.hpp): first all merges (as rows of a sparse or dense matrix), then all nodes
+// NOTE: A dense matrix multiplies unconnected slots by 0, which would turn inf or NaN in them into NaN, so such steps use the edges
+inline void evaluateLayer(const Program& prog, const LayerPlan& plan, const Layer& layer,
+                          const MergeKernel mergeKernel, const DenseKernel denseKernel, const std::uint32_t* edgeSource,
+                          const double* inputs, const double* v, double* out, double* m)
+{
+    const std::uint32_t mergeBegin(prog.nodeMergeBegin[layer.nodeBegin]);
+    const std::uint32_t mergeEnd(prog.nodeMergeBegin[layer.nodeEnd]);
+    if (layer.dense && allFinite(out + layer.columnBegin, layer.columns))
+    {
+        denseKernel(plan.denseWeights.data() + layer.denseBegin, mergeEnd - mergeBegin, layer.columns,
+                    out + layer.columnBegin, prog.mergeBias.data() + mergeBegin, m + mergeBegin);
+    } else {
+        for (std::size_t n = layer.nodeBegin; n < layer.nodeEnd; ++n)
+            evaluateMerges(prog, n, mergeKernel, edgeSource, v, m);
+    }
+
+    // Nodes of a single input read consecutive merges and write consecutive slots
+    const NodeOp op(prog.nodeOps[layer.nodeBegin]);
+    if (mergeEnd - mergeBegin == layer.nodeEnd - layer.nodeBegin)
+    {
+        applyNodeBatch(op, m + mergeBegin, layer.nodeEnd - layer.nodeBegin, out + prog.nodeSlotBegin[layer.nodeBegin], prog.precision);
+    } else {
+        for (std::size_t n = layer.nodeBegin; n < layer.nodeEnd; ++n)
+            evaluateNode(prog, n, inputs, out, m);
+    }
+}
+
+}
+
+#endif
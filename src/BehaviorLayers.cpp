@@ -0,0 +1,85 @@
+#include "BehaviorLayers.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace Behavior {
+
+// Built-in functions with one input per merge and a single output can be part of a layer
+static bool isLayerNode(const Program& program, const std::size_t n)
+{
+    const NodeOp op(program.nodeOps[n]);
+    if ((op == NodeOp::INPUT) || (op == NodeOp::EXTERN) || (op == NodeOp::SUBGRAPH))
+        return false;
+    return (program.nodeMergeBegin[n+1] - program.nodeMergeBegin[n] == arityOf(op)) &&
+           (program.nodeSlotBegin[n+1] - program.nodeSlotBegin[n] == 1);
+}
+
+static Layer layerOf(const Program& program, const std::uint32_t begin, const std::uint32_t end, std::vector<double>& denseWeights)
+{
+    Layer layer{begin, end, false, 0, 0, 0};
+    const std::uint32_t mergeBegin(program.nodeMergeBegin[begin]);
+    const std::uint32_t mergeEnd(program.nodeMergeBegin[end]);
+
+    // Dense layers read the slots of the current step only (delayed edges read the other buffer if double buffered)
+    bool denseable(true);
+    std::uint32_t first(std::numeric_limits<std::uint32_t>::max());
+    std::uint32_t last(0);
+    for (std::uint32_t k = mergeBegin; denseable && (k < mergeEnd); ++k)
+    {
+        if ((program.mergeOps[k] != MergeOp::SUM) || (program.mergeEdgeBegin[k] == program.mergeEdgeBegin[k+1]))
+            denseable = false;
+    }
+    for (std::uint32_t e = program.mergeEdgeBegin[mergeBegin]; denseable && (e < program.mergeEdgeBegin[mergeEnd]); ++e)
+    {
+        if (program.edgeDelayed[e] && (program.feedback == Feedback::DOUBLE_BUFFERED))
+            denseable = false;
+        first = std::min(first, program.edgeSource[e]);
+        last = std::max(last, program.edgeSource[e]);
+    }
+    if (!denseable)
+        return layer;
+
+    const std::size_t rows(mergeEnd - mergeBegin);
+    const std::size_t columns(last - first + 1);
+    const std::size_t edges(program.mergeEdgeBegin[mergeEnd] - program.mergeEdgeBegin[mergeBegin]);
+    if (edges < DenseLayerThreshold * rows * columns)
+        return layer;
+
+    // Edges from the same slot add up
+    layer.dense = true;
+    layer.columnBegin = first;
+    layer.columns = columns;
+    layer.denseBegin = denseWeights.size();
+    denseWeights.resize(denseWeights.size() + rows * columns, 0.0);
+    for (std::uint32_t k = mergeBegin; k < mergeEnd; ++k)
+    {
+        double* row(denseWeights.data() + layer.denseBegin + (k - mergeBegin) * columns);
+        for (std::uint32_t e = program.mergeEdgeBegin[k]; e < program.mergeEdgeBegin[k+1]; ++e)
+            row[program.edgeSource[e] - first] += program.edgeWeight[e];
+    }
+    return layer;
+}
+
+LayerPlan planLayers(const Program& program)
+{
+    LayerPlan plan;
+    for (std::size_t l = 0; l < program.levels(); ++l)
+    {
+        // Runs of consecutive nodes applying the same function
+        const std::uint32_t levelEnd(program.levelBegin[l+1]);
+        std::uint32_t n(program.levelBegin[l]);
+        while (n < levelEnd)
+        {
+            std::uint32_t end(n);
+            while ((end < levelEnd) && (program.nodeOps[end] == program.nodeOps[n]) && isLayerNode(program, end))
+                end++;
+            if (end - n >= MinLayerNodes)
+                plan.layers.push_back(layerOf(program, n, end, plan.denseWeights));
+            n = std::max(end, n + 1);
+        }
+    }
+    return plan;
+}
+
+}
@@ -0,0 +1,377 @@
+#include "BehaviorSimd.hpp"
+#include "BehaviorKernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BEHAVIOR_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Behavior {
+
+static double mergeScalar(const MergeOp op, const double bias, const double defaultValue,
+                          const std::uint32_t* sources, const double* weights, const std::size_t n,
+                          const double* values)
+{
+    return applyMerge(op, bias, defaultValue, sources, weights, n, values);
+}
+
+static void denseScalar(const double* weights, const std::size_t rows, const std::size_t columns,
+                        const double* x, const double* bias, double* y)
+{
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        const double* w(weights + r * columns);
+        double result(0.0);
+        for (std::size_t c = 0; c < columns; ++c)
+            result += w[c] * x[c];
+        y[r] = result + bias[r];
+    }
+}
+
+#ifdef BEHAVIOR_X86_SIMD
+
+// NOTE: Some intrinsics are implemented on top of undefined vectors which triggers false positives
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/*
+    AVX2 kernels
+    Four edges are processed at once: the source values are gathered by their slot indices,
+    multiplied by the weights and reduced into a vector accumulator.
+    The remaining (n % 4) edges are handled by scalar code.
+    MIN and MAX start every lane from the first edge and pass the accumulator as the second operand,
+    which the instructions return if either operand is NaN. So NaNs are ignored unless the first value is one, as in applyMerge.
+*/
+
+// NOTE: The masked gathers avoid the undefined source operand of the plain ones
+__attribute__((target("avx2,fma")))
+static inline __m256d gather4(const std::uint32_t* sources, const double* values)
+{
+    const __m128i idx(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sources)));
+    const __m256d zero(_mm256_setzero_pd());
+    return _mm256_mask_i32gather_pd(zero, values, idx, _mm256_cmp_pd(zero, zero, _CMP_EQ_OQ), sizeof(double));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d gatherWeighted4(const std::uint32_t* sources, const double* weights, const double* values)
+{
+    return _mm256_mul_pd(_mm256_loadu_pd(weights), gather4(sources, values));
+}
+
+__attribute__((target("avx2,fma")))
+static inline double reduceAdd4(const __m256d x)
+{
+    const __m128d y(_mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1)));
+    return _mm_cvtsd_f64(_mm_add_sd(y, _mm_unpackhi_pd(y, y)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline double reduceMul4(const __m256d x)
+{
+    const __m128d y(_mm_mul_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1)));
+    return _mm_cvtsd_f64(_mm_mul_sd(y, _mm_unpackhi_pd(y, y)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline double reduceMin4(const __m256d x)
+{
+    const __m128d y(_mm_min_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1)));
+    return _mm_cvtsd_f64(_mm_min_sd(y, _mm_unpackhi_pd(y, y)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline double reduceMax4(const __m256d x)
+{
+    const __m128d y(_mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1)));
+    return _mm_cvtsd_f64(_mm_max_sd(y, _mm_unpackhi_pd(y, y)));
+}
+
+__attribute__((target("avx2,fma")))
+static double mergeAvx2(const MergeOp op, const double bias, const double defaultValue,
+                        const std::uint32_t* sources, const double* weights, const std::size_t n,
+                        const double* values)
+{
+    if (n < 4)
+        return applyMerge(op, bias, defaultValue, sources, weights, n, values);
+
+    const std::size_t vn(n & ~std::size_t(3));
+    double result;
+    switch (op)
+    {
+        case MergeOp::SUM:
+        case MergeOp::MEAN:
+        {
+            // Two accumulators hide the latency of the FMA
+            __m256d acc0(_mm256_setzero_pd());
+            __m256d acc1(_mm256_setzero_pd());
+            std::size_t e(0);
+            for (; e + 8 <= vn; e += 8)
+            {
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(weights + e), gather4(sources + e, values), acc0);
+                acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(weights + e + 4), gather4(sources + e + 4, values), acc1);
+            }
+            if (e < vn)
+                acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(weights + e), gather4(sources + e, values), acc0);
+            result = reduceAdd4(_mm256_add_pd(acc0, acc1));
+            for (std::size_t e = vn; e < n; ++e)
+                result += weights[e] * values[sources[e]];
+            if (op == MergeOp::MEAN)
+                result /= n;
+            break;
+        }
+        case MergeOp::PRODUCT:
+        {
+            __m256d acc(gatherWeighted4(sources, weights, values));
+            for (std::size_t e = 4; e < vn; e += 4)
+                acc = _mm256_mul_pd(acc, gatherWeighted4(sources + e, weights + e, values));
+            result = reduceMul4(acc);
+            for (std::size_t e = vn; e < n; ++e)
+                result *= weights[e] * values[sources[e]];
+            break;
+        }
+        case MergeOp::MIN:
+        {
+            // Every lane starts from the first edge (NaN semantics of applyMerge, see above)
+            __m256d acc(_mm256_set1_pd(weights[0] * values[sources[0]]));
+            for (std::size_t e = 0; e < vn; e += 4)
+                acc = _mm256_min_pd(gatherWeighted4(sources + e, weights + e, values), acc);
+            result = reduceMin4(acc);
+            for (std::size_t e = vn; e < n; ++e)
+                result = std::min(result, weights[e] * values[sources[e]]);
+            break;
+        }
+        case MergeOp::MAX:
+        {
+            // Every lane starts from the first edge (NaN semantics of applyMerge, see above)
+            __m256d acc(_mm256_set1_pd(weights[0] * values[sources[0]]));
+            for (std::size_t e = 0; e < vn; e += 4)
+                acc = _mm256_max_pd(gatherWeighted4(sources + e, weights + e, values), acc);
+            result = reduceMax4(acc);
+            for (std::size_t e = vn; e < n; ++e)
+                result = std::max(result, weights[e] * values[sources[e]]);
+            break;
+        }
+        case MergeOp::NORM:
+        {
+            __m256d acc(_mm256_setzero_pd());
+            for (std::size_t e = 0; e < vn; e += 4)
+            {
+                const __m256d x(gatherWeighted4(sources + e, weights + e, values));
+                acc = _mm256_fmadd_pd(x, x, acc);
+            }
+            result = reduceAdd4(acc);
+            for (std::size_t e = vn; e < n; ++e)
+            {
+                const double x(weights[e] * values[sources[e]]);
+                result += x * x;
+            }
+            result = std::sqrt(result);
+            break;
+        }
+        default:
+            result = 0.0;
+            break;
+    }
+    return result + bias;
+}
+
+// Every row is a dot product of contiguous weights and values (no gathers needed)
+__attribute__((target("avx2,fma")))
+static void denseAvx2(const double* weights, const std::size_t rows, const std::size_t columns,
+                      const double* x, const double* bias, double* y)
+{
+    const std::size_t vc(columns & ~std::size_t(7));
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        const double* w(weights + r * columns);
+        __m256d acc0(_mm256_setzero_pd());
+        __m256d acc1(_mm256_setzero_pd());
+        for (std::size_t c = 0; c < vc; c += 8)
+        {
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(w + c), _mm256_loadu_pd(x + c), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(w + c + 4), _mm256_loadu_pd(x + c + 4), acc1);
+        }
+        double result(reduceAdd4(_mm256_add_pd(acc0, acc1)));
+        for (std::size_t c = vc; c < columns; ++c)
+            result += w[c] * x[c];
+        y[r] = result + bias[r];
+    }
+}
+
+/*
+    AVX-512 kernels
+    Same scheme as above, but with eight edges at once.
+*/
+
+__attribute__((target("avx512f")))
+static inline __m512d gather8(const std::uint32_t* sources, const double* values)
+{
+    const __m256i idx(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(sources)));
+    return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, idx, values, sizeof(double));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d gatherWeighted8(const std::uint32_t* sources, const double* weights, const double* values)
+{
+    return _mm512_mul_pd(_mm512_loadu_pd(weights), gather8(sources, values));
+}
+
+__attribute__((target("avx512f")))
+static double mergeAvx512(const MergeOp op, const double bias, const double defaultValue,
+                          const std::uint32_t* sources, const double* weights, const std::size_t n,
+                          const double* values)
+{
+    if (n < 8)
+        return mergeAvx2(op, bias, defaultValue, sources, weights, n, values);
+
+    const std::size_t vn(n & ~std::size_t(7));
+    double result;
+    switch (op)
+    {
+        case MergeOp::SUM:
+        case MergeOp::MEAN:
+        {
+            __m512d acc0(_mm512_setzero_pd());
+            __m512d acc1(_mm512_setzero_pd());
+            std::size_t e(0);
+            for (; e + 16 <= vn; e += 16)
+            {
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(weights + e), gather8(sources + e, values), acc0);
+                acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(weights + e + 8), gather8(sources + e + 8, values), acc1);
+            }
+            if (e < vn)
+                acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(weights + e), gather8(sources + e, values), acc0);
+            result = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+            for (std::size_t e = vn; e < n; ++e)
+                result += weights[e] * values[sources[e]];
+            if (op == MergeOp::MEAN)
+                result /= n;
+            break;
+        }
+        case MergeOp::PRODUCT:
+        {
+            __m512d acc(gatherWeighted8(sources, weights, values));
+            for (std::size_t e = 8; e < vn; e += 8)
+                acc = _mm512_mul_pd(acc, gatherWeighted8(sources + e, weights + e, values));
+            result = _mm512_reduce_mul_pd(acc);
+            for (std::size_t e = vn; e < n; ++e)
+                result *= weights[e] * values[sources[e]];
+            break;
+        }
+        case MergeOp::MIN:
+        {
+            // Every lane starts from the first edge (NaN semantics of applyMerge, see above)
+            __m512d acc(_mm512_set1_pd(weights[0] * values[sources[0]]));
+            for (std::size_t e = 0; e < vn; e += 8)
+                acc = _mm512_min_pd(gatherWeighted8(sources + e, weights + e, values), acc);
+            result = _mm512_reduce_min_pd(acc);
+            for (std::size_t e = vn; e < n; ++e)
+                result = std::min(result, weights[e] * values[sources[e]]);
+            break;
+        }
+        case MergeOp::MAX:
+        {
+            // Every lane starts from the first edge (NaN semantics of applyMerge, see above)
+            __m512d acc(_mm512_set1_pd(weights[0] * values[sources[0]]));
+            for (std::size_t e = 0; e < vn; e += 8)
+                acc = _mm512_max_pd(gatherWeighted8(sources + e, weights + e, values), acc);
+            result = _mm512_reduce_max_pd(acc);
+            for (std::size_t e = vn; e < n; ++e)
+                result = std::max(result, weights[e] * values[sources[e]]);
+            break;
+        }
+        case MergeOp::NORM:
+        {
+            __m512d acc(_mm512_setzero_pd());
+            for (std::size_t e = 0; e < vn; e += 8)
+            {
+                const __m512d x(gatherWeighted8(sources + e, weights + e, values));
+                acc = _mm512_fmadd_pd(x, x, acc);
+            }
+            result = _mm512_reduce_add_pd(acc);
+            for (std::size_t e = vn; e < n; ++e)
+            {
+                const double x(weights[e] * values[sources[e]]);
+                result += x * x;
+            }
+            result = std::sqrt(result);
+            break;
+        }
+        default:
+            result = 0.0;
+            break;
+    }
+    return result + bias;
+}
+
+__attribute__((target("avx512f")))
+static void denseAvx512(const double* weights, const std::size_t rows, const std::size_t columns,
+                        const double* x, const double* bias, double* y)
+{
+    const std::size_t vc(columns & ~std::size_t(15));
+    for (std::size_t r = 0; r < rows; ++r)
+    {
+        const double* w(weights + r * columns);
+        __m512d acc0(_mm512_setzero_pd());
+        __m512d acc1(_mm512_setzero_pd());
+        for (std::size_t c = 0; c < vc; c += 16)
+        {
+            acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(w + c), _mm512_loadu_pd(x + c), acc0);
+            acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(w + c + 8), _mm512_loadu_pd(x + c + 8), acc1);
+        }
+        double result(_mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1)));
+        for (std::size_t c = vc; c < columns; ++c)
+            result += w[c] * x[c];
+        y[r] = result + bias[r];
+    }
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+SimdLevel detectSimdLevel()
+{
+#ifdef BEHAVIOR_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdLevel::AVX2;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+MergeKernel mergeKernelFor(const SimdLevel level)
+{
+#ifdef BEHAVIOR_X86_SIMD
+    switch (level)
+    {
+        case SimdLevel::AVX512:
+            return mergeAvx512;
+        case SimdLevel::AVX2:
+            return mergeAvx2;
+        default:
+            break;
+    }
+#endif
+    return mergeScalar;
+}
+
+DenseKernel denseKernelFor(const SimdLevel level)
+{
+#ifdef BEHAVIOR_X86_SIMD
+    switch (level)
+    {
+        case SimdLevel::AVX512:
+            return denseAvx512;
+        case SimdLevel::AVX2:
+            return denseAvx2;
+        default:
+            break;
+    }
+#endif
+    return denseScalar;
+}
+
+}
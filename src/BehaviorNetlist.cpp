@@ -0,0 +1,541 @@
+#include "BehaviorNetlist.hpp"
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace Behavior {
+
+std::size_t arityOf(const NodeOp op)
+{
+    switch (op)
+    {
+        case NodeOp::INPUT:
+            return 0;
+        case NodeOp::ATAN2:
+        case NodeOp::POW:
+        case NodeOp::MOD:
+            return 2;
+        case NodeOp::GREATER_ZERO:
+        case NodeOp::APPROX_ZERO:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+std::string nameOf(const NodeOp op)
+{
+    switch (op)
+    {
+        case NodeOp::PIPE: return "PIPE";
+        case NodeOp::INPUT: return "INPUT";
+        case NodeOp::OUTPUT: return "OUTPUT";
+        case NodeOp::DIVIDE: return "DIVIDE";
+        case NodeOp::SIN: return "SIN";
+        case NodeOp::COS: return "COS";
+        case NodeOp::TAN: return "TAN";
+        case NodeOp::TANH: return "TANH";
+        case NodeOp::ACOS: return "ACOS";
+        case NodeOp::ASIN: return "ASIN";
+        case NodeOp::ATAN: return "ATAN";
+        case NodeOp::LOG: return "LOG";
+        case NodeOp::EXP: return "EXP";
+        case NodeOp::ABS: return "ABS";
+        case NodeOp::SQRT: return "SQRT";
+        case NodeOp::ATAN2: return "ATAN2";
+        case NodeOp::POW: return "POW";
+        case NodeOp::MOD: return "MOD";
+        case NodeOp::GREATER_ZERO: return "GREATER_ZERO";
+        case NodeOp::APPROX_ZERO: return "APPROX_ZERO";
+        case NodeOp::EXTERN: return "EXTERN";
+        case NodeOp::SUBGRAPH: return "SUBGRAPH";
+    }
+    return "";
+}
+
+std::string nameOf(const MergeOp op)
+{
+    switch (op)
+    {
+        case MergeOp::SUM: return "SUM";
+        case MergeOp::PRODUCT: return "PRODUCT";
+        case MergeOp::MIN: return "MIN";
+        case MergeOp::MAX: return "MAX";
+        case MergeOp::MEAN: return "MEAN";
+        case MergeOp::NORM: return "NORM";
+    }
+    return "";
+}
+
+std::vector< std::vector<std::size_t> > successorsOf(const Netlist& netlist)
+{
+    std::vector< std::vector<std::size_t> > successors(netlist.nodes.size());
+    for (std::size_t i = 0; i < netlist.nodes.size(); ++i)
+    {
+        for (const Netlist::Merge& merge : netlist.nodes[i].inputs)
+        {
+            for (const Netlist::Edge& edge : merge.edges)
+            {
+                if ((edge.fromNode == i) || edge.delayed)
+                    continue;
+                successors[edge.fromNode].push_back(i);
+            }
+        }
+    }
+    return successors;
+}
+
+// Tarjan's algorithm (iterative)
+std::vector<std::size_t> componentsOf(const std::vector< std::vector<std::size_t> >& successors, std::size_t& count)
+{
+    const std::size_t n(successors.size());
+    const std::size_t unvisited(std::numeric_limits<std::size_t>::max());
+    std::vector<std::size_t> index(n, unvisited);
+    std::vector<std::size_t> lowlink(n, 0);
+    std::vector<std::size_t> component(n, unvisited);
+    std::vector<bool> onStack(n, false);
+    std::vector<std::size_t> stack;
+    std::vector< std::pair<std::size_t, std::size_t> > callStack;
+    std::size_t nextIndex(0);
+    count = 0;
+
+    for (std::size_t root = 0; root < n; ++root)
+    {
+        if (index[root] != unvisited)
+            continue;
+        callStack.push_back(std::make_pair(root, 0));
+        while (!callStack.empty())
+        {
+            const std::size_t v(callStack.back().first);
+            std::size_t& next(callStack.back().second);
+            if (next == 0 && index[v] == unvisited)
+            {
+                index[v] = lowlink[v] = nextIndex++;
+                stack.push_back(v);
+                onStack[v] = true;
+            }
+            if (next < successors[v].size())
+            {
+                const std::size_t w(successors[v][next++]);
+                if (index[w] == unvisited)
+                    callStack.push_back(std::make_pair(w, 0));
+                else if (onStack[w])
+                    lowlink[v] = std::min(lowlink[v], index[w]);
+                continue;
+            }
+            if (lowlink[v] == index[v])
+            {
+                std::size_t w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = false;
+                    component[w] = count;
+                } while (w != v);
+                count++;
+            }
+            callStack.pop_back();
+            if (!callStack.empty())
+            {
+                const std::size_t u(callStack.back().first);
+                lowlink[u] = std::min(lowlink[u], lowlink[v]);
+            }
+        }
+    }
+    return component;
+}
+
+// Orders the nodes such that every node comes after the sources of its (not delayed) incoming edges.
+// Nodes on cycles can not be ordered this way: Inside a cycle the first unscheduled node (preferably one fed
+// from outside of the cycle) is forced and its feedback edges will read the value of the previous step.
+static std::vector<std::size_t> scheduleOf(const Netlist& netlist)
+{
+    const std::size_t n(netlist.nodes.size());
+    const std::vector< std::vector<std::size_t> > successors(successorsOf(netlist));
+    std::size_t components;
+    const std::vector<std::size_t> component(componentsOf(successors, components));
+
+    // Group nodes by component (in topological order of the components)
+    std::vector< std::vector<std::size_t> > members(components);
+    for (std::size_t i = 0; i < n; ++i)
+        members[components - 1 - component[i]].push_back(i);
+
+    // Count the dependencies inside of each component
+    std::vector<std::size_t> indegree(n, 0);
+    std::vector<bool> isEntry(n, false);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        for (const std::size_t s : successors[i])
+        {
+            if (component[s] == component[i])
+                indegree[s]++;
+            else
+                isEntry[s] = true;
+        }
+    }
+
+    std::vector<std::size_t> order;
+    std::vector<bool> queued(n, false);
+    order.reserve(n);
+    for (std::vector<std::size_t>& nodes : members)
+    {
+        // Cycles are entered where they are fed from the outside
+        std::stable_partition(nodes.begin(), nodes.end(), [&isEntry](const std::size_t i) { return isEntry[i]; });
+        std::vector<std::size_t> queue;
+        for (const std::size_t i : nodes)
+        {
+            if (indegree[i])
+                continue;
+            queue.push_back(i);
+            queued[i] = true;
+        }
+        std::size_t head(0);
+        std::size_t nextForced(0);
+        while (head < nodes.size())
+        {
+            if (head == queue.size())
+            {
+                // Stuck in a cycle
+                while (queued[nodes[nextForced]])
+                    nextForced++;
+                queue.push_back(nodes[nextForced]);
+                queued[nodes[nextForced]] = true;
+            }
+            const std::size_t i(queue[head++]);
+            order.push_back(i);
+            for (const std::size_t s : successors[i])
+            {
+                if ((component[s] != component[i]) || --indegree[s] || queued[s])
+                    continue;
+                queue.push_back(s);
+                queued[s] = true;
+            }
+        }
+    }
+    return order;
+}
+
+std::size_t breakCycles(Netlist& netlist)
+{
+    const std::vector<std::size_t> order(scheduleOf(netlist));
+    std::vector<std::size_t> position(order.size());
+    for (std::size_t p = 0; p < order.size(); ++p)
+        position[order[p]] = p;
+
+    // Edges pointing backwards in the schedule close a cycle
+    std::size_t count(0);
+    for (std::size_t i = 0; i < netlist.nodes.size(); ++i)
+    {
+        for (Netlist::Merge& merge : netlist.nodes[i].inputs)
+        {
+            for (Netlist::Edge& edge : merge.edges)
+            {
+                if (edge.delayed || (position[edge.fromNode] < position[i]))
+                    continue;
+                edge.delayed = true;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// Returns the indices of the INPUT and OUTPUT nodes of a body sorted by name
+static std::vector<std::size_t> interfaceNodesOf(const Netlist& body, const NodeOp op)
+{
+    std::vector<std::size_t> result;
+    for (std::size_t i = 0; i < body.nodes.size(); ++i)
+    {
+        if (body.nodes[i].op == op)
+            result.push_back(i);
+    }
+    std::stable_sort(result.begin(), result.end(), [&body](const std::size_t a, const std::size_t b) { return body.nodes[a].name < body.nodes[b].name; });
+    return result;
+}
+
+// Returns the interface node for the given interface name (or else by index)
+// NOTE: Numeric names (like the idx of the YAML format) are indices, otherwise the position of the name is used
+static std::size_t interfaceNodeFor(const Netlist& body, const std::vector<std::size_t>& candidates, const std::vector<std::string>& names, const std::size_t pos)
+{
+    const std::string& name(names[pos]);
+    for (const std::size_t i : candidates)
+    {
+        if (body.nodes[i].name == name)
+            return i;
+    }
+    const bool isNumeric(!name.empty() && (name.find_first_not_of("0123456789") == std::string::npos));
+    const std::size_t idx(isNumeric ? std::stoul(name) : pos);
+    return idx < candidates.size() ? candidates[idx] : body.nodes.size();
+}
+
+Netlist inlineSubgraphs(const Netlist& netlist, const std::vector<const Netlist*>& bodies)
+{
+    typedef std::pair<std::size_t, std::size_t> Port;
+    const std::size_t invalid(-1);
+
+    // Layout: Every node is either copied or replaced by its body
+    std::vector<std::size_t> base(netlist.nodes.size(), invalid);
+    std::map<Port, Port> outputs;
+    std::size_t count(0);
+    for (std::size_t i = 0; i < netlist.nodes.size(); ++i)
+    {
+        const Netlist::Node& node(netlist.nodes[i]);
+        base[i] = count;
+        if (node.op != NodeOp::SUBGRAPH)
+        {
+            for (std::size_t o = 0; o < node.outputNames.size(); ++o)
+                outputs[Port(i, o)] = Port(count, o);
+            count++;
+            continue;
+        }
+        if (!bodies[i])
+            continue;
+        const Netlist& body(*bodies[i]);
+        const std::vector<std::size_t> outputNodes(interfaceNodesOf(body, NodeOp::OUTPUT));
+        for (std::size_t o = 0; o < node.outputNames.size(); ++o)
+        {
+            const std::size_t j(interfaceNodeFor(body, outputNodes, node.outputNames, o));
+            if (j < body.nodes.size())
+                outputs[Port(i, o)] = Port(count + j, 0);
+        }
+        count += body.nodes.size();
+    }
+
+    // Remaps the edges of a merge of the outer netlist (edges from unresolved outputs are dropped)
+    auto remap = [&outputs](const Netlist::Merge& merge) -> Netlist::Merge {
+        Netlist::Merge result(merge);
+        result.edges.clear();
+        for (const Netlist::Edge& edge : merge.edges)
+        {
+            std::map<Port, Port>::const_iterator it(outputs.find(Port(edge.fromNode, edge.fromOutput)));
+            if (it == outputs.end())
+                continue;
+            result.edges.push_back(Netlist::Edge{it->second.first, it->second.second, edge.weight, edge.uid, edge.delayed});
+        }
+        return result;
+    };
+
+    Netlist result;
+    result.name = netlist.name;
+    result.nodes.reserve(count);
+    for (std::size_t i = 0; i < netlist.nodes.size(); ++i)
+    {
+        const Netlist::Node& node(netlist.nodes[i]);
+        if (node.op != NodeOp::SUBGRAPH)
+        {
+            result.nodes.push_back(node);
+            for (Netlist::Merge& merge : result.nodes.back().inputs)
+                merge = remap(merge);
+            continue;
+        }
+        if (!bodies[i])
+            continue;
+
+        // The INPUT nodes of the body get the merges of the instance
+        const Netlist& body(*bodies[i]);
+        const std::vector<std::size_t> inputNodes(interfaceNodesOf(body, NodeOp::INPUT));
+        std::vector<std::size_t> inputOf(body.nodes.size(), invalid);
+        for (std::size_t k = 0; k < node.inputs.size(); ++k)
+        {
+            const std::size_t j(interfaceNodeFor(body, inputNodes, node.inputNames, k));
+            if (j < body.nodes.size())
+                inputOf[j] = k;
+        }
+        for (std::size_t j = 0; j < body.nodes.size(); ++j)
+        {
+            Netlist::Node inner(body.nodes[j]);
+            inner.name = node.name + "/" + inner.name;
+            for (Netlist::Merge& merge : inner.inputs)
+            {
+                for (Netlist::Edge& edge : merge.edges)
+                    edge.fromNode += base[i];
+            }
+            if (inner.op == NodeOp::INPUT)
+            {
+                // Unconnected inputs behave like a merge without edges
+                inner.inputNames.assign(1, "0");
+                inner.inputs.assign(1, Netlist::Merge{MergeOp::SUM, 0.0, 0.0, std::vector<Netlist::Edge>(), ""});
+                if (inputOf[j] != invalid)
+                    inner.inputs[0] = remap(node.inputs[inputOf[j]]);
+            }
+            if ((inner.op == NodeOp::INPUT) || (inner.op == NodeOp::OUTPUT))
+                inner.op = NodeOp::PIPE;
+            result.nodes.push_back(inner);
+        }
+    }
+    return result;
+}
+
+std::size_t removePipes(Netlist& netlist, std::vector<std::string>* removedNames)
+{
+    const std::size_t n(netlist.nodes.size());
+
+    // A removable PIPE forwards the only edge of its SUM merge
+    auto forwardOf = [&netlist](const std::size_t i) -> const Netlist::Edge* {
+        const Netlist::Node& node(netlist.nodes[i]);
+        if ((node.op != NodeOp::PIPE) || (node.inputs.size() != 1))
+            return NULL;
+        const Netlist::Merge& merge(node.inputs[0]);
+        if ((merge.op != MergeOp::SUM) || (merge.bias != 0.0) || (merge.edges.size() != 1))
+            return NULL;
+        return &merge.edges[0];
+    };
+
+    // Rewire the readers (weights are multiplied only if one of them is 1, so nothing is rounded)
+    for (Netlist::Node& node : netlist.nodes)
+    {
+        for (Netlist::Merge& merge : node.inputs)
+        {
+            for (Netlist::Edge& edge : merge.edges)
+            {
+                // Follow chains of PIPEs, but not around a cycle of PIPEs
+                for (std::size_t hops = 0; hops < n; ++hops)
+                {
+                    const Netlist::Edge* forward(forwardOf(edge.fromNode));
+                    if (!forward || (forward->fromNode == edge.fromNode))
+                        break;
+                    if ((edge.weight != 1.0) && (forward->weight != 1.0))
+                        break;
+                    // A delay of two steps can not be expressed
+                    if (edge.delayed && forward->delayed)
+                        break;
+                    edge.delayed = edge.delayed || forward->delayed;
+                    edge.weight *= forward->weight;
+                    edge.fromNode = forward->fromNode;
+                    edge.fromOutput = forward->fromOutput;
+                }
+            }
+        }
+    }
+
+    // Drop the PIPEs nobody reads anymore
+    std::vector<bool> isRead(n, false);
+    for (const Netlist::Node& node : netlist.nodes)
+    {
+        for (const Netlist::Merge& merge : node.inputs)
+        {
+            for (const Netlist::Edge& edge : merge.edges)
+                isRead[edge.fromNode] = true;
+        }
+    }
+    std::vector<bool> removed(n, false);
+    std::size_t count(0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        removed[i] = !isRead[i] && (forwardOf(i) != NULL);
+        if (!removed[i])
+            continue;
+        if (removedNames)
+            removedNames->push_back(netlist.nodes[i].name);
+        count++;
+    }
+    removeNodes(netlist, removed);
+    return count;
+}
+
+void removeNodes(Netlist& netlist, const std::vector<bool>& removed)
+{
+    const std::size_t n(netlist.nodes.size());
+    std::vector<std::size_t> newIndex(n);
+    std::size_t count(0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        newIndex[i] = count;
+        if (removed[i])
+            continue;
+        if (count != i)
+            netlist.nodes[count] = std::move(netlist.nodes[i]);
+        count++;
+    }
+    netlist.nodes.resize(count);
+    for (Netlist::Node& node : netlist.nodes)
+    {
+        for (Netlist::Merge& merge : node.inputs)
+        {
+            merge.edges.erase(std::remove_if(merge.edges.begin(), merge.edges.end(),
+                                             [&removed](const Netlist::Edge& edge) { return removed[edge.fromNode]; }),
+                              merge.edges.end());
+            for (Netlist::Edge& edge : merge.edges)
+                edge.fromNode = newIndex[edge.fromNode];
+        }
+    }
+}
+
+std::string exportNetlist(const Netlist& netlist)
+{
+    // Labels of the built-in NODE and MERGE classes (see Graph::setupMetaModel)
+    static const char* nodeLabels[] = {"PIPE", "INPUT", "OUTPUT", "DIVIDE", "SIN", "COS", "TAN", "TANH", "ACOS", "ASIN", "ATAN",
+                                       "LOG", "EXP", "ABS", "SQRT", "ATAN2", "POW", "MOD", ">0", "==0"};
+    static const char* mergeLabels[] = {"SUM", "PRODUCT", "MIN", "MAX", "MEAN", "NORM"};
+    for (const Netlist::Node& node : netlist.nodes)
+    {
+        if (node.op == NodeOp::SUBGRAPH)
+            return std::string();
+    }
+
+    YAML::Emitter out;
+    out.SetDoublePrecision(17);
+    out << YAML::BeginMap;
+    out << YAML::Key << "model" << YAML::Value << netlist.name;
+    out << YAML::Key << "nodes" << YAML::Value << YAML::BeginSeq;
+    for (std::size_t n = 0; n < netlist.nodes.size(); ++n)
+    {
+        const Netlist::Node& node(netlist.nodes[n]);
+        out << YAML::BeginMap;
+        out << YAML::Key << "id" << YAML::Value << n + 1;
+        out << YAML::Key << "name" << YAML::Value << node.name;
+        out << YAML::Key << "inputs" << YAML::Value << YAML::BeginSeq;
+        // INPUT nodes have an input (without merge) which becomes the input of the model
+        if (node.op == NodeOp::INPUT)
+            out << YAML::Flow << YAML::BeginMap << YAML::Key << "idx" << YAML::Value << 0 << YAML::EndMap;
+        for (std::size_t i = 0; i < node.inputs.size(); ++i)
+        {
+            const Netlist::Merge& merge(node.inputs[i]);
+            out << YAML::Flow << YAML::BeginMap;
+            out << YAML::Key << "idx" << YAML::Value << i;
+            out << YAML::Key << "bias" << YAML::Value << merge.bias;
+            out << YAML::Key << "default" << YAML::Value << merge.defaultValue;
+            out << YAML::Key << "type" << YAML::Value << mergeLabels[static_cast<std::size_t>(merge.op)];
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+        out << YAML::Key << "outputs" << YAML::Value << YAML::BeginSeq;
+        for (std::size_t o = 0; o < std::max<std::size_t>(1, node.outputNames.size()); ++o)
+            out << YAML::Flow << YAML::BeginMap << YAML::Key << "idx" << YAML::Value << o << YAML::EndMap;
+        out << YAML::EndSeq;
+        if (node.op == NodeOp::EXTERN)
+        {
+            out << YAML::Key << "type" << YAML::Value << "EXTERN";
+            out << YAML::Key << "extern_name" << YAML::Value << node.externName;
+        } else {
+            out << YAML::Key << "type" << YAML::Value << nodeLabels[static_cast<std::size_t>(node.op)];
+        }
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+
+    out << YAML::Key << "edges" << YAML::Value << YAML::BeginSeq;
+    for (std::size_t n = 0; n < netlist.nodes.size(); ++n)
+    {
+        for (std::size_t i = 0; i < netlist.nodes[n].inputs.size(); ++i)
+        {
+            for (const Netlist::Edge& edge : netlist.nodes[n].inputs[i].edges)
+            {
+                out << YAML::Flow << YAML::BeginMap;
+                out << YAML::Key << "fromNodeId" << YAML::Value << edge.fromNode + 1;
+                out << YAML::Key << "fromNodeOutputIdx" << YAML::Value << edge.fromOutput;
+                out << YAML::Key << "toNodeId" << YAML::Value << n + 1;
+                out << YAML::Key << "toNodeInputIdx" << YAML::Value << i;
+                out << YAML::Key << "weight" << YAML::Value << edge.weight;
+                out << YAML::EndMap;
+            }
+        }
+    }
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+    return out.c_str();
+}
+
+}
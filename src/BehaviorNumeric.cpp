@@ -0,0 +1,73 @@
+#include "BehaviorNumeric.hpp"
+#include "BehaviorKernels.hpp"
+
+#include <cstdlib>
+
+namespace Behavior {
+
+FixedPoint::FixedPoint(const unsigned integerBits, const unsigned fractionalBits)
+: fracBits(std::min(fractionalBits, 31u)),
+  intBits(std::min(integerBits, 31u - fracBits)),
+  maxRaw((std::int64_t(1) << (intBits + fracBits)) - 1),
+  minRaw(-maxRaw - 1),
+  numSaturated(0)
+{
+}
+
+bool FixedPoint::parse(const std::string& text, unsigned& integerBits, unsigned& fractionalBits)
+{
+    if ((text.size() < 4) || ((text[0] != 'Q') && (text[0] != 'q')))
+        return false;
+    const char* begin(text.c_str() + 1);
+    char* end;
+    const unsigned long m(std::strtoul(begin, &end, 10));
+    if ((end == begin) || (*end != '.'))
+        return false;
+    begin = end + 1;
+    const unsigned long n(std::strtoul(begin, &end, 10));
+    if ((end == begin) || (*end != '\0') || (m + n > 31))
+        return false;
+    integerBits = m;
+    fractionalBits = n;
+    return true;
+}
+
+std::string FixedPoint::format() const
+{
+    return "Q" + std::to_string(intBits) + "." + std::to_string(fracBits);
+}
+
+FixedPoint::Value FixedPoint::fromReal(const double x)
+{
+    // NaN becomes zero, everything out of range saturates (before the conversion to integer)
+    if (x != x)
+        return 0;
+    const double scaled(std::floor(std::ldexp(x, fracBits) + 0.5));
+    if (scaled > static_cast<double>(maxRaw))
+        return saturate(maxRaw + 1);
+    if (scaled < static_cast<double>(minRaw))
+        return saturate(minRaw - 1);
+    return static_cast<Value>(scaled);
+}
+
+FixedPoint::Value FixedPoint::apply(const NodeOp op, const Value* in)
+{
+    switch (op)
+    {
+        case NodeOp::PIPE:
+        case NodeOp::OUTPUT:
+            return in[0];
+        case NodeOp::ABS:
+            return saturate(std::llabs(static_cast<std::int64_t>(in[0])));
+        case NodeOp::GREATER_ZERO:
+            return in[0] > 0 ? in[1] : in[2];
+        default:
+            break;
+    }
+
+    // All other functions are rounded from their exact result
+    const double real[3] = {toReal(in[0]), toReal(in[1]), toReal(in[2])};
+    return fromReal(applyNode(op, real, Precision::EXACT));
+}
+
+}
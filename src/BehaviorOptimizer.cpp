@@ -0,0 +1,283 @@
+#include "BehaviorOptimizer.hpp"
+#include "BehaviorKernels.hpp"
+
+#include <map>
+
+namespace Behavior {
+
+std::ostream& operator<<(std::ostream& os, const OptimizerReport& report)
+{
+    os << "Removed " << report.zeroEdges << " zero edges\n";
+    os << "Folded " << report.foldedNodes << " constant nodes\n";
+    os << "Removed " << report.deadNodes << " dead nodes\n";
+    os << "Bypassed " << report.pipes << " pipes\n";
+    os << "Merged " << report.duplicates << " duplicate nodes\n";
+    for (const std::string& name : report.removedNodes)
+        os << "  - " << name << "\n";
+    return os;
+}
+
+// Nodes which have to stay (interface and side effects)
+static bool isPinned(const Netlist::Node& node)
+{
+    return (node.op == NodeOp::INPUT) || (node.op == NodeOp::OUTPUT) || (node.op == NodeOp::EXTERN);
+}
+
+// Removes the given nodes and records their names
+static std::size_t removeNodesOf(Netlist& netlist, const std::vector<bool>& removed, OptimizerReport& report)
+{
+    std::size_t count(0);
+    for (std::size_t i = 0; i < netlist.nodes.size(); ++i)
+    {
+        if (!removed[i])
+            continue;
+        report.removedNodes.push_back(netlist.nodes[i].name);
+        count++;
+    }
+    if (count)
+        removeNodes(netlist, removed);
+    return count;
+}
+
+static std::size_t removeZeroEdges(Netlist& netlist)
+{
+    std::size_t count(0);
+    for (Netlist::Node& node : netlist.nodes)
+    {
+        for (Netlist::Merge& merge : node.inputs)
+        {
+            const std::size_t before(merge.edges.size());
+            bool hasZero(false);
+            for (const Netlist::Edge& edge : merge.edges)
+                hasZero = hasZero || (edge.weight == 0.0);
+            if (!hasZero)
+                continue;
+            switch (merge.op)
+            {
+                case MergeOp::SUM:
+                case MergeOp::NORM:
+                    merge.edges.erase(std::remove_if(merge.edges.begin(), merge.edges.end(),
+                                                     [](const Netlist::Edge& edge) { return edge.weight == 0.0; }),
+                                      merge.edges.end());
+                    break;
+                case MergeOp::PRODUCT:
+                    merge.edges.clear();
+                    break;
+                default:
+                    // MIN, MAX and MEAN depend on the zero
+                    continue;
+            }
+            // Nothing left: The merge yields its bias
+            if (merge.edges.empty())
+            {
+                merge.op = MergeOp::SUM;
+                merge.defaultValue = merge.bias;
+            }
+            count += before - merge.edges.size();
+        }
+    }
+    return count;
+}
+
+static std::size_t foldConstants(Netlist& netlist, const Precision precision)
+{
+    const std::size_t n(netlist.nodes.size());
+    const std::vector< std::vector<std::size_t> > successors(successorsOf(netlist));
+
+    // A node is constant as soon as all of its sources are (self loops and delayed edges are never resolved)
+    std::vector<std::size_t> pending(n, 0);
+    std::vector<std::size_t> ready;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const Netlist::Node& node(netlist.nodes[i]);
+        for (const Netlist::Merge& merge : node.inputs)
+            pending[i] += merge.edges.size();
+        const bool isFoldable((node.op != NodeOp::INPUT) && (node.op != NodeOp::EXTERN) && (node.op != NodeOp::SUBGRAPH));
+        if (!isFoldable)
+            pending[i] = Program::npos;
+        else if (!pending[i])
+            ready.push_back(i);
+    }
+
+    std::vector<double> value(n, 0.0);
+    std::vector<std::uint32_t> sources;
+    std::vector<double> weights;
+    std::vector<double> merged;
+    std::size_t count(0);
+    while (!ready.empty())
+    {
+        const std::size_t i(ready.back());
+        ready.pop_back();
+        Netlist::Node& node(netlist.nodes[i]);
+        merged.clear();
+        for (Netlist::Merge& merge : node.inputs)
+        {
+            sources.clear();
+            weights.clear();
+            for (const Netlist::Edge& edge : merge.edges)
+            {
+                sources.push_back(edge.fromNode);
+                weights.push_back(edge.weight);
+            }
+            merged.push_back(applyMerge(merge.op, merge.bias, merge.defaultValue, sources.data(), weights.data(), sources.size(), value.data()));
+        }
+        value[i] = applyNode(node.op, merged.data(), precision);
+
+        // Replace the node by a constant (unless it is one already)
+        const bool isConstant((node.op == NodeOp::PIPE) || (node.op == NodeOp::OUTPUT));
+        if (!isConstant || !node.inputs[0].edges.empty() || (node.inputs[0].bias != 0.0) || (node.inputs[0].op != MergeOp::SUM))
+        {
+            if (node.op != NodeOp::OUTPUT)
+                node.op = NodeOp::PIPE;
+            node.inputNames.assign(1, "0");
+            node.inputs.assign(1, Netlist::Merge{MergeOp::SUM, 0.0, value[i], std::vector<Netlist::Edge>(), ""});
+            count++;
+        }
+
+        // There is one successor entry per edge
+        for (const std::size_t s : successors[i])
+        {
+            if ((pending[s] != Program::npos) && !--pending[s])
+                ready.push_back(s);
+        }
+    }
+    return count;
+}
+
+static std::size_t removeDeadNodes(Netlist& netlist, OptimizerReport& report)
+{
+    const std::size_t n(netlist.nodes.size());
+    std::vector<bool> isAlive(n, false);
+    std::vector<std::size_t> stack;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (netlist.nodes[i].op == NodeOp::OUTPUT)
+            stack.push_back(i);
+    }
+    if (stack.empty())
+        return 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (isPinned(netlist.nodes[i]) && (netlist.nodes[i].op != NodeOp::OUTPUT))
+            stack.push_back(i);
+    }
+
+    // Everything an OUTPUT (or EXTERN) node depends on is alive
+    while (!stack.empty())
+    {
+        const std::size_t i(stack.back());
+        stack.pop_back();
+        if (isAlive[i])
+            continue;
+        isAlive[i] = true;
+        for (const Netlist::Merge& merge : netlist.nodes[i].inputs)
+        {
+            for (const Netlist::Edge& edge : merge.edges)
+                stack.push_back(edge.fromNode);
+        }
+    }
+
+    std::vector<bool> removed(n);
+    for (std::size_t i = 0; i < n; ++i)
+        removed[i] = !isAlive[i];
+    return removeNodesOf(netlist, removed, report);
+}
+
+// Appends the bits of a value to a signature
+template<typename T> static void append(std::string& signature, const T& value)
+{
+    signature.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static std::size_t mergeDuplicates(Netlist& netlist, OptimizerReport& report)
+{
+    const std::size_t n(netlist.nodes.size());
+    const std::vector< std::vector<std::size_t> > successors(successorsOf(netlist));
+    std::size_t components;
+    const std::vector<std::size_t> component(componentsOf(successors, components));
+
+    // Visit the nodes in topological order (components are numbered in reverse), so sources are merged first
+    // NOTE: The cycles are broken already, so every component is a single node
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&component](const std::size_t a, const std::size_t b) { return component[a] > component[b]; });
+
+    std::vector<std::size_t> representative(n);
+    for (std::size_t i = 0; i < n; ++i)
+        representative[i] = i;
+    std::map<std::string, std::size_t> known;
+    std::vector<bool> removed(n, false);
+    for (const std::size_t i : order)
+    {
+        Netlist::Node& node(netlist.nodes[i]);
+        for (Netlist::Merge& merge : node.inputs)
+        {
+            for (Netlist::Edge& edge : merge.edges)
+                edge.fromNode = representative[edge.fromNode];
+        }
+        if (isPinned(node) || (node.op == NodeOp::SUBGRAPH))
+            continue;
+
+        // Equal signatures mean equal values (the order of the edges matters for rounding)
+        std::string signature;
+        append(signature, node.op);
+        for (const Netlist::Merge& merge : node.inputs)
+        {
+            append(signature, merge.op);
+            append(signature, merge.bias);
+            append(signature, merge.defaultValue);
+            append(signature, merge.edges.size());
+            for (const Netlist::Edge& edge : merge.edges)
+            {
+                append(signature, edge.fromNode);
+                append(signature, edge.fromOutput);
+                append(signature, edge.weight);
+                append(signature, edge.delayed);
+            }
+        }
+        std::map<std::string, std::size_t>::const_iterator it(known.find(signature));
+        if (it == known.end())
+        {
+            known[signature] = i;
+            continue;
+        }
+        representative[i] = it->second;
+        removed[i] = true;
+    }
+
+    // Delayed edges may read nodes merged after their reader
+    for (Netlist::Node& node : netlist.nodes)
+    {
+        for (Netlist::Merge& merge : node.inputs)
+        {
+            for (Netlist::Edge& edge : merge.edges)
+                edge.fromNode = representative[edge.fromNode];
+        }
+    }
+    return removeNodesOf(netlist, removed, report);
+}
+
+OptimizerReport optimize(Netlist& netlist, const Precision precision)
+{
+    OptimizerReport report{0, 0, 0, 0, 0, std::vector<std::string>()};
+    // With explicit delays, none of the passes can move a delay by changing the node order
+    breakCycles(netlist);
+    bool changed(true);
+    while (changed)
+    {
+        const std::size_t before(report.zeroEdges + report.foldedNodes + report.deadNodes + report.pipes + report.duplicates);
+        report.zeroEdges += removeZeroEdges(netlist);
+        report.foldedNodes += foldConstants(netlist, precision);
+        report.deadNodes += removeDeadNodes(netlist, report);
+
+        const std::size_t pipes(removePipes(netlist, &report.removedNodes));
+        report.pipes += pipes;
+
+        report.duplicates += mergeDuplicates(netlist, report);
+        changed = (report.zeroEdges + report.foldedNodes + report.deadNodes + report.pipes + report.duplicates) != before;
+    }
+    return report;
+}
+
+}
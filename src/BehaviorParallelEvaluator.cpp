@@ -0,0 +1,202 @@
+#include "BehaviorParallelEvaluator.hpp"
+#include "BehaviorKernels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Behavior {
+
+// Number of nodes claimed at once
+static const std::uint32_t ChunkSize = 32;
+// Levels with less nodes per thread are not worth a barrier
+static const std::size_t MinNodesPerThread = 16;
+// Waiting strategy of the barrier
+static const std::size_t SpinCount = 1024;
+static const std::size_t YieldCount = 16384;
+
+static inline void relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+ParallelEvaluator::ParallelEvaluator(const Program& program, const std::size_t threads, const bool pinThreads, const SimdLevel level)
+: prog(program),
+  mergeKernel(mergeKernelFor(level)),
+  numThreads(std::max<std::size_t>(threads, 1)),
+  values(program.slots() * program.buffers(), 0.0),
+  merged(program.merges(), 0.0),
+  inputs(program.inputNames.size(), 0.0),
+  buffer(0),
+  offset(0),
+  shares(numThreads),
+  arrived(0),
+  released(false),
+  stopping(false),
+  sense(false)
+{
+    for (std::size_t b = 0; b < prog.buffers(); ++b)
+        sources[b] = prog.sourcesOf(b);
+
+    // Split the program into phases
+    for (std::size_t l = 0; l < prog.levels(); ++l)
+    {
+        const std::uint32_t begin(prog.levelBegin[l]);
+        const std::uint32_t end(prog.levelBegin[l+1]);
+        const bool parallel((end - begin) >= numThreads * MinNodesPerThread);
+        if (!parallel && !phaseParallel.empty() && !phaseParallel.back())
+        {
+            // Coalesce consecutive serial levels
+            phaseEnd.back() = end;
+            continue;
+        }
+        phaseBegin.push_back(begin);
+        phaseEnd.push_back(end);
+        phaseParallel.push_back(parallel);
+    }
+
+    // Start the workers (the calling thread is worker 0)
+    for (std::size_t id = 1; id < numThreads; ++id)
+    {
+        workers.push_back(std::thread(&ParallelEvaluator::work, this, id));
+#ifdef __linux__
+        if (pinThreads)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(id % CPU_SETSIZE, &cpus);
+            pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpus), &cpus);
+        }
+#endif
+    }
+}
+
+ParallelEvaluator::~ParallelEvaluator()
+{
+    // Wake up the workers to let them quit
+    stopping.store(true, std::memory_order_relaxed);
+    sync(sense, 0);
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ParallelEvaluator::reset()
+{
+    std::fill(values.begin(), values.end(), 0.0);
+    std::fill(merged.begin(), merged.end(), 0.0);
+    std::fill(inputs.begin(), inputs.end(), 0.0);
+    buffer = 0;
+    offset = 0;
+}
+
+void ParallelEvaluator::step()
+{
+    // Every step writes the buffer read by the next one (published to the workers by the barrier)
+    buffer = (buffer + 1) % prog.buffers();
+    offset = buffer * prog.slots();
+
+    // Without any parallel phase there is no need to wake up the workers
+    if ((numThreads < 2) || (std::find(phaseParallel.begin(), phaseParallel.end(), true) == phaseParallel.end()))
+    {
+        evaluateNodes(prog, 0, prog.nodes(), mergeKernel, sources[buffer].data(),
+                      inputs.data(), values.data(), values.data() + offset, merged.data());
+        return;
+    }
+
+    sync(sense, 0);
+    for (std::size_t p = 0; p < phases(); ++p)
+    {
+        runPhase(0, p);
+        sync(sense, p + 1);
+    }
+}
+
+void ParallelEvaluator::work(const std::size_t id)
+{
+    bool mySense(false);
+    while (true)
+    {
+        sync(mySense, 0);
+        if (stopping.load(std::memory_order_relaxed))
+            break;
+        for (std::size_t p = 0; p < phases(); ++p)
+        {
+            runPhase(id, p);
+            sync(mySense, p + 1);
+        }
+    }
+}
+
+void ParallelEvaluator::runPhase(const std::size_t id, const std::size_t phase)
+{
+    if (!phaseParallel[phase])
+    {
+        if (id == 0)
+            evaluateNodes(prog, phaseBegin[phase], phaseEnd[phase], mergeKernel, sources[buffer].data(),
+                          inputs.data(), values.data(), values.data() + offset, merged.data());
+        return;
+    }
+
+    // Own share first, then steal from the others
+    for (std::size_t i = 0; i < numThreads; ++i)
+        claimNodes(shares[(id + i) % numThreads]);
+}
+
+void ParallelEvaluator::claimNodes(Share& share)
+{
+    while (true)
+    {
+        const std::uint32_t begin(share.next.fetch_add(ChunkSize, std::memory_order_relaxed));
+        if (begin >= share.end)
+            break;
+        evaluateNodes(prog, begin, std::min(begin + ChunkSize, share.end), mergeKernel, sources[buffer].data(),
+                      inputs.data(), values.data(), values.data() + offset, merged.data());
+    }
+}
+
+// Sense reversing barrier: the last thread to arrive prepares the next phase and releases the others
+void ParallelEvaluator::sync(bool& mySense, const std::size_t nextPhase)
+{
+    mySense = !mySense;
+    if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == numThreads)
+    {
+        arrived.store(0, std::memory_order_relaxed);
+        if (nextPhase < phases())
+            prepare(nextPhase);
+        released.store(mySense, std::memory_order_release);
+        return;
+    }
+
+    for (std::size_t i = 0; released.load(std::memory_order_acquire) != mySense; ++i)
+    {
+        if (i < SpinCount)
+            relax();
+        else if (i < YieldCount)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+void ParallelEvaluator::prepare(const std::size_t phase)
+{
+    if (!phaseParallel[phase])
+        return;
+    const std::size_t begin(phaseBegin[phase]);
+    const std::size_t count(phaseEnd[phase] - begin);
+    for (std::size_t i = 0; i < numThreads; ++i)
+    {
+        shares[i].next.store(begin + count * i / numThreads, std::memory_order_relaxed);
+        shares[i].end = begin + count * (i + 1) / numThreads;
+    }
+}
+
+}
@@ -0,0 +1,170 @@
+#include "BehaviorProfiler.hpp"
+#include "BehaviorKernels.hpp"
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <sstream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Behavior {
+
+static inline std::uint64_t readTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* profileUnit()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+ProfilingEvaluator::ProfilingEvaluator(const Program& program, const SimdLevel level)
+: Evaluator(program, level, false)
+{
+    resetProfile();
+}
+
+void ProfilingEvaluator::resetProfile()
+{
+    numSteps = 0;
+    nodeCalls.assign(prog.nodes(), 0);
+    nodeMergeTicks.assign(prog.nodes(), 0);
+    nodeOpTicks.assign(prog.nodes(), 0);
+}
+
+void ProfilingEvaluator::step()
+{
+    // The program may have changed (see Evaluator::update)
+    if (nodeCalls.size() != prog.nodes())
+        resetProfile();
+
+    buffer = (buffer + 1) % prog.buffers();
+    offset = buffer * prog.slots();
+    const std::uint32_t* edgeSource(sources[buffer].data());
+    double* out(values.data() + offset);
+
+    // Every reading of the counter ends one measurement and starts the next
+    std::uint64_t start(readTicks());
+    for (std::size_t n = 0; n < prog.nodes(); ++n)
+    {
+        evaluateMerges(prog, n, mergeKernel, edgeSource, values.data(), merged.data());
+        const std::uint64_t mergesDone(readTicks());
+        evaluateNode(prog, n, inputs.data(), out, merged.data());
+        const std::uint64_t nodeDone(readTicks());
+        nodeCalls[n]++;
+        nodeMergeTicks[n] += mergesDone - start;
+        nodeOpTicks[n] += nodeDone - mergesDone;
+        start = nodeDone;
+    }
+    numSteps++;
+}
+
+std::size_t ProfilingEvaluator::fanInOf(const std::size_t node) const
+{
+    return prog.mergeEdgeBegin[prog.nodeMergeBegin[node+1]] - prog.mergeEdgeBegin[prog.nodeMergeBegin[node]];
+}
+
+// Returns the nodes sorted by their ticks (the most expensive first)
+static std::vector<std::size_t> nodesByTicks(const ProfilingEvaluator& evaluator)
+{
+    std::vector<std::size_t> order(evaluator.program().nodes());
+    for (std::size_t n = 0; n < order.size(); ++n)
+        order[n] = n;
+    std::stable_sort(order.begin(), order.end(), [&evaluator](const std::size_t a, const std::size_t b) {
+        return evaluator.mergeTicks()[a] + evaluator.nodeTicks()[a] > evaluator.mergeTicks()[b] + evaluator.nodeTicks()[b];
+    });
+    return order;
+}
+
+std::string profileToYAML(const ProfilingEvaluator& evaluator)
+{
+    const Program& prog(evaluator.program());
+
+    // Sum up the nodes of every (nested) instance: a/b/c belongs to a and a/b
+    std::uint64_t total(0);
+    std::map< std::string, std::pair<std::uint64_t, std::size_t> > instances;
+    for (std::size_t n = 0; n < prog.nodes(); ++n)
+    {
+        const std::uint64_t ticks(evaluator.mergeTicks()[n] + evaluator.nodeTicks()[n]);
+        const std::string name(prog.symbols.str(prog.nodeNames[n]));
+        total += ticks;
+        for (std::size_t pos = name.find('/'); pos != std::string::npos; pos = name.find('/', pos + 1))
+        {
+            std::pair<std::uint64_t, std::size_t>& instance(instances[name.substr(0, pos)]);
+            instance.first += ticks;
+            instance.second++;
+        }
+    }
+    std::vector< std::pair<std::uint64_t, std::string> > instancesByTicks;
+    for (const std::pair< const std::string, std::pair<std::uint64_t, std::size_t> >& instance : instances)
+        instancesByTicks.push_back(std::make_pair(instance.second.first, instance.first));
+    std::stable_sort(instancesByTicks.begin(), instancesByTicks.end(),
+                     [](const std::pair<std::uint64_t, std::string>& a, const std::pair<std::uint64_t, std::string>& b) { return a.first > b.first; });
+
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "model" << YAML::Value << prog.name;
+    out << YAML::Key << "unit" << YAML::Value << profileUnit();
+    out << YAML::Key << "steps" << YAML::Value << evaluator.steps();
+    out << YAML::Key << "ticks" << YAML::Value << total;
+    if (!instancesByTicks.empty())
+    {
+        out << YAML::Key << "subgraphs" << YAML::Value << YAML::BeginSeq;
+        for (const std::pair<std::uint64_t, std::string>& instance : instancesByTicks)
+        {
+            out << YAML::BeginMap;
+            out << YAML::Key << "name" << YAML::Value << instance.second;
+            out << YAML::Key << "nodes" << YAML::Value << instances[instance.second].second;
+            out << YAML::Key << "ticks" << YAML::Value << instance.first;
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+    }
+    out << YAML::Key << "nodes" << YAML::Value << YAML::BeginSeq;
+    for (const std::size_t n : nodesByTicks(evaluator))
+    {
+        out << YAML::BeginMap;
+        out << YAML::Key << "name" << YAML::Value << prog.symbols.str(prog.nodeNames[n]);
+        out << YAML::Key << "id" << YAML::Value << prog.symbols.str(prog.nodeUids[n]);
+        out << YAML::Key << "type" << YAML::Value << nameOf(prog.nodeOps[n]);
+        out << YAML::Key << "calls" << YAML::Value << evaluator.calls()[n];
+        out << YAML::Key << "merge_ticks" << YAML::Value << evaluator.mergeTicks()[n];
+        out << YAML::Key << "node_ticks" << YAML::Value << evaluator.nodeTicks()[n];
+        out << YAML::Key << "merges" << YAML::Value << prog.nodeMergeBegin[n+1] - prog.nodeMergeBegin[n];
+        out << YAML::Key << "fan_in" << YAML::Value << evaluator.fanInOf(n);
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+    return out.c_str();
+}
+
+std::string profileToFoldedStacks(const ProfilingEvaluator& evaluator)
+{
+    const Program& prog(evaluator.program());
+    const std::string model(prog.name.empty() ? "model" : prog.name);
+    std::ostringstream out;
+    for (std::size_t n = 0; n < prog.nodes(); ++n)
+    {
+        // Instances become frames, ';' would separate frames as well
+        std::string frames(prog.symbols.str(prog.nodeNames[n]));
+        std::replace(frames.begin(), frames.end(), ';', '_');
+        std::replace(frames.begin(), frames.end(), '/', ';');
+        out << model << ";" << frames << " " << evaluator.mergeTicks()[n] + evaluator.nodeTicks()[n] << "\n";
+    }
+    return out.str();
+}
+
+}
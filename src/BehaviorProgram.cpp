@@ -0,0 +1,286 @@
+#include "BehaviorProgram.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace Behavior {
+
+const std::size_t Program::npos = std::numeric_limits<std::size_t>::max();
+
+// Assigns every node a dependency level: Forward edges have to be evaluated before the node reading them.
+// When evaluating in place, delayed edges have to be read before their source is overwritten.
+// Hence, all nodes of one level can be evaluated concurrently. Returns nothing if these constraints are cyclic.
+static std::vector<std::size_t> levelsOf(const Netlist& netlist, const Feedback feedback)
+{
+    const std::size_t n(netlist.nodes.size());
+    std::vector< std::vector<std::size_t> > after(n);
+    std::vector<std::size_t> indegree(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        for (const Netlist::Merge& merge : netlist.nodes[i].inputs)
+        {
+            for (const Netlist::Edge& edge : merge.edges)
+            {
+                if (edge.fromNode == i)
+                    continue;
+                if (!edge.delayed)
+                {
+                    after[edge.fromNode].push_back(i);
+                    indegree[i]++;
+                } else if (feedback == Feedback::IN_PLACE) {
+                    after[i].push_back(edge.fromNode);
+                    indegree[edge.fromNode]++;
+                }
+            }
+        }
+    }
+
+    std::vector<std::size_t> level(n, 0);
+    std::vector<std::size_t> queue;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!indegree[i])
+            queue.push_back(i);
+    }
+    for (std::size_t head = 0; head < queue.size(); ++head)
+    {
+        const std::size_t i(queue[head]);
+        for (const std::size_t s : after[i])
+        {
+            level[s] = std::max(level[s], level[i] + 1);
+            if (!--indegree[s])
+                queue.push_back(s);
+        }
+    }
+    if (queue.size() < n)
+        return std::vector<std::size_t>();
+    return level;
+}
+
+Program::Program()
+: precision(Precision::EXACT),
+  feedback(Feedback::IN_PLACE)
+{
+}
+
+Program::Program(const Netlist& netlist, const Precision precision, const Feedback feedback)
+: name(netlist.name),
+  precision(precision),
+  feedback(feedback)
+{
+    // Make the feedback edges explicit (see breakCycles)
+    Netlist broken(netlist);
+    breakCycles(broken);
+    std::vector<std::size_t> level(levelsOf(broken, feedback));
+    if (level.empty())
+    {
+        // The delayed edges can not be evaluated in place
+        this->feedback = Feedback::DOUBLE_BUFFERED;
+        level = levelsOf(broken, Feedback::DOUBLE_BUFFERED);
+    }
+
+    // Order the nodes by level
+    std::vector<std::size_t> order(broken.nodes.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&level](const std::size_t a, const std::size_t b) { return level[a] < level[b]; });
+    for (std::size_t p = 0; p < order.size(); ++p)
+    {
+        while (levelBegin.size() <= level[order[p]])
+            levelBegin.push_back(p);
+    }
+    levelBegin.push_back(order.size());
+
+    // Assign value slots to node outputs
+    std::vector<std::uint32_t> firstSlotOf(broken.nodes.size());
+    std::uint32_t slot(0);
+    nodeSlotBegin.reserve(order.size() + 1);
+    for (const std::size_t i : order)
+    {
+        firstSlotOf[i] = slot;
+        nodeSlotBegin.push_back(slot);
+        slot += broken.nodes[i].outputNames.size();
+    }
+    nodeSlotBegin.push_back(slot);
+
+    // Flatten nodes, merges and edges
+    nodeMergeBegin.push_back(0);
+    mergeEdgeBegin.push_back(0);
+    for (const std::size_t i : order)
+    {
+        const Netlist::Node& node(broken.nodes[i]);
+        nodeOps.push_back(node.op);
+        nodeNames.push_back(symbols.intern(node.name));
+        nodeUids.push_back(symbols.intern(node.uid));
+        switch (node.op)
+        {
+            case NodeOp::INPUT:
+                nodePort.push_back(inputNames.size());
+                inputNames.push_back(nodeNames.back());
+                break;
+            case NodeOp::OUTPUT:
+                nodePort.push_back(outputNames.size());
+                outputNames.push_back(nodeNames.back());
+                outputSlots.push_back(firstSlotOf[i]);
+                break;
+            case NodeOp::EXTERN:
+                nodePort.push_back(externNames.size());
+                externNames.push_back(symbols.intern(node.externName));
+                externBindings.push_back(ExternBinding{NULL, NULL});
+                break;
+            default:
+                nodePort.push_back(0);
+                break;
+        }
+
+        for (const Netlist::Merge& merge : node.inputs)
+        {
+            mergeOps.push_back(merge.op);
+            mergeBias.push_back(merge.bias);
+            mergeDefault.push_back(merge.defaultValue);
+            mergeUids.push_back(symbols.intern(merge.uid));
+            for (const Netlist::Edge& edge : merge.edges)
+            {
+                edgeSource.push_back(firstSlotOf[edge.fromNode] + edge.fromOutput);
+                edgeWeight.push_back(edge.weight);
+                edgeDelayed.push_back(edge.delayed);
+                edgeUids.push_back(symbols.intern(edge.uid));
+            }
+            mergeEdgeBegin.push_back(edgeSource.size());
+        }
+        nodeMergeBegin.push_back(mergeOps.size());
+    }
+    symbols.shrink();
+}
+
+std::vector<std::uint32_t> Program::sourcesOf(const std::size_t buffer) const
+{
+    if (buffers() < 2)
+        return edgeSource;
+    // Feedback edges read the other buffer
+    std::vector<std::uint32_t> sources(edgeSource);
+    for (std::size_t e = 0; e < sources.size(); ++e)
+        sources[e] += (edgeDelayed[e] ? 1 - buffer : buffer) * slots();
+    return sources;
+}
+
+std::size_t Program::inputIndex(const std::string& name) const
+{
+    const Symbol symbol(symbols.find(name));
+    for (std::size_t i = 0; i < inputNames.size(); ++i)
+    {
+        if (inputNames[i] == symbol)
+            return i;
+    }
+    return npos;
+}
+
+std::size_t Program::outputIndex(const std::string& name) const
+{
+    const Symbol symbol(symbols.find(name));
+    for (std::size_t i = 0; i < outputNames.size(); ++i)
+    {
+        if (outputNames[i] == symbol)
+            return i;
+    }
+    return npos;
+}
+
+std::size_t Program::levelOf(const std::size_t node) const
+{
+    return std::upper_bound(levelBegin.begin(), levelBegin.end(), node) - levelBegin.begin() - 1;
+}
+
+std::size_t Program::nodeOf(const std::size_t merge) const
+{
+    return std::upper_bound(nodeMergeBegin.begin(), nodeMergeBegin.end(), merge) - nodeMergeBegin.begin() - 1;
+}
+
+std::vector<bool> Program::demandOf(const std::vector<std::size_t>& outputs) const
+{
+    // The owner of every slot
+    std::vector<std::uint32_t> nodeOfSlot(slots());
+    for (std::size_t n = 0; n < nodes(); ++n)
+        std::fill(nodeOfSlot.begin() + nodeSlotBegin[n], nodeOfSlot.begin() + nodeSlotBegin[n+1], n);
+
+    // The requested OUTPUT nodes and all EXTERN nodes (side effects) are the roots
+    std::vector<std::size_t> stack;
+    for (std::size_t n = 0; n < nodes(); ++n)
+    {
+        if ((nodeOps[n] == NodeOp::EXTERN) ||
+            ((nodeOps[n] == NodeOp::OUTPUT) && (std::find(outputs.begin(), outputs.end(), nodePort[n]) != outputs.end())))
+            stack.push_back(n);
+    }
+
+    // Everything they depend on, also by feedback edges (the state of the next step)
+    std::vector<bool> demanded(nodes(), false);
+    while (!stack.empty())
+    {
+        const std::size_t n(stack.back());
+        stack.pop_back();
+        if (demanded[n])
+            continue;
+        demanded[n] = true;
+        for (std::uint32_t e = mergeEdgeBegin[nodeMergeBegin[n]]; e < mergeEdgeBegin[nodeMergeBegin[n+1]]; ++e)
+            stack.push_back(nodeOfSlot[edgeSource[e]]);
+    }
+    return demanded;
+}
+
+void Program::insertEdge(const std::size_t merge, const std::uint32_t source, const double weight, const bool delayed, const UniqueId& uid)
+{
+    const std::uint32_t e(mergeEdgeBegin[merge + 1]);
+    edgeSource.insert(edgeSource.begin() + e, source);
+    edgeWeight.insert(edgeWeight.begin() + e, weight);
+    edgeDelayed.insert(edgeDelayed.begin() + e, delayed);
+    edgeUids.insert(edgeUids.begin() + e, symbols.intern(uid));
+    for (std::size_t k = merge + 1; k < mergeEdgeBegin.size(); ++k)
+        mergeEdgeBegin[k]++;
+}
+
+void Program::removeEdge(const std::size_t edge)
+{
+    edgeSource.erase(edgeSource.begin() + edge);
+    edgeWeight.erase(edgeWeight.begin() + edge);
+    edgeDelayed.erase(edgeDelayed.begin() + edge);
+    edgeUids.erase(edgeUids.begin() + edge);
+    for (std::size_t k = std::upper_bound(mergeEdgeBegin.begin(), mergeEdgeBegin.end(), edge) - mergeEdgeBegin.begin(); k < mergeEdgeBegin.size(); ++k)
+        mergeEdgeBegin[k]--;
+}
+
+Netlist netlistOf(const Program& program)
+{
+    Netlist netlist;
+    netlist.name = program.name;
+    std::vector<std::size_t> nodeOf(program.slots());
+    for (std::size_t n = 0; n < program.nodes(); ++n)
+    {
+        for (std::uint32_t s = program.nodeSlotBegin[n]; s < program.nodeSlotBegin[n+1]; ++s)
+            nodeOf[s] = n;
+    }
+
+    for (std::size_t n = 0; n < program.nodes(); ++n)
+    {
+        Netlist::Node node{program.nodeOps[n], program.symbols.str(program.nodeNames[n]), program.symbols.str(program.nodeUids[n]), "", {}, {}, {}};
+        for (std::uint32_t k = program.nodeMergeBegin[n]; k < program.nodeMergeBegin[n+1]; ++k)
+        {
+            Netlist::Merge merge{program.mergeOps[k], program.mergeBias[k], program.mergeDefault[k], {}, program.symbols.str(program.mergeUids[k])};
+            for (std::uint32_t e = program.mergeEdgeBegin[k]; e < program.mergeEdgeBegin[k+1]; ++e)
+            {
+                const std::uint32_t source(program.edgeSource[e]);
+                merge.edges.push_back(Netlist::Edge{nodeOf[source], source - program.nodeSlotBegin[nodeOf[source]],
+                                                    program.edgeWeight[e], program.symbols.str(program.edgeUids[e]), program.edgeDelayed[e] != 0});
+            }
+            node.inputNames.push_back(std::to_string(node.inputs.size()));
+            node.inputs.push_back(merge);
+        }
+        for (std::uint32_t s = program.nodeSlotBegin[n]; s < program.nodeSlotBegin[n+1]; ++s)
+            node.outputNames.push_back(std::to_string(s - program.nodeSlotBegin[n]));
+        if (node.op == NodeOp::EXTERN)
+            node.externName = program.symbols.str(program.externNames[program.nodePort[n]]);
+        netlist.nodes.push_back(node);
+    }
+    return netlist;
+}
+
+}
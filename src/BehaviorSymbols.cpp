@@ -0,0 +1,102 @@
+#include "BehaviorSymbols.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace Behavior {
+
+const Symbol SymbolTable::npos = std::numeric_limits<Symbol>::max();
+
+// FNV-1a
+static std::uint32_t hashOf(const char* text, const std::size_t length)
+{
+    std::uint32_t hash(2166136261u);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(text[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+SymbolTable::SymbolTable()
+: buckets(16, 0)
+{
+}
+
+Symbol SymbolTable::find(const char* text, const std::size_t length, const std::uint32_t hash, std::size_t& bucket) const
+{
+    const std::size_t mask(buckets.size() - 1);
+    for (bucket = hash & mask; buckets[bucket]; bucket = (bucket + 1) & mask)
+    {
+        const Symbol symbol(buckets[bucket] - 1);
+        if ((hashes[symbol] == hash) && (lengthOf(symbol) == length) && (std::memcmp(str(symbol), text, length) == 0))
+            return symbol;
+    }
+    return npos;
+}
+
+std::size_t SymbolTable::lengthOf(const Symbol symbol) const
+{
+    const std::size_t end(symbol + 1 < offsets.size() ? offsets[symbol + 1] : chars.size());
+    return end - offsets[symbol] - 1;
+}
+
+Symbol SymbolTable::find(const std::string& text) const
+{
+    std::size_t bucket;
+    return find(text.data(), text.size(), hashOf(text.data(), text.size()), bucket);
+}
+
+Symbol SymbolTable::intern(const std::string& text)
+{
+    return intern(text.data(), text.size());
+}
+
+Symbol SymbolTable::intern(const char* text, const std::size_t length)
+{
+    const std::uint32_t hash(hashOf(text, length));
+    std::size_t bucket;
+    const Symbol existing(find(text, length, hash, bucket));
+    if (existing != npos)
+        return existing;
+
+    const Symbol symbol(offsets.size());
+    offsets.push_back(chars.size());
+    hashes.push_back(hash);
+    chars.append(text, length);
+    chars.push_back('\0');
+    buckets[bucket] = symbol + 1;
+    // Keep the load factor below 1/2
+    if (2 * offsets.size() > buckets.size())
+        grow();
+    return symbol;
+}
+
+void SymbolTable::grow()
+{
+    std::vector<std::uint32_t> old(2 * buckets.size(), 0);
+    old.swap(buckets);
+    const std::size_t mask(buckets.size() - 1);
+    for (Symbol symbol = 0; symbol < offsets.size(); ++symbol)
+    {
+        std::size_t bucket(hashes[symbol] & mask);
+        while (buckets[bucket])
+            bucket = (bucket + 1) & mask;
+        buckets[bucket] = symbol + 1;
+    }
+}
+
+void SymbolTable::shrink()
+{
+    chars.shrink_to_fit();
+    offsets.shrink_to_fit();
+    hashes.shrink_to_fit();
+}
+
+std::size_t SymbolTable::bytes() const
+{
+    return chars.capacity() + (offsets.capacity() + hashes.capacity() + buckets.capacity()) * sizeof(std::uint32_t);
+}
+
+}
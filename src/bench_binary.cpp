@@ -0,0 +1,111 @@
+#include "BehaviorBinary.hpp"
+#include "BehaviorEvaluator.hpp"
+#include "benchmark_models.hpp"
+
+#include <yaml-cpp/yaml.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"file", required_argument, 0, 'f'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--file=<binary-file>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--file=<binary-file>\t" << "Temporary file (default: bench_binary.bgb)\n";
+    std::cout << "\nCompares loading a synthetic model of about 100k edges from the binary format against parsing its bg file.\n";
+    std::cout << "Returns 0 if the loaded program behaves like the original one.\n";
+}
+
+static double millisecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main (int argc, char **argv)
+{
+    std::string fileName("bench_binary.bgb");
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hf:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'f':
+                fileName = optarg;
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    const Behavior::Netlist netlist(layeredModel(100, 250));
+    const Behavior::Program program(netlist);
+    if (!Behavior::saveProgram(program, fileName))
+    {
+        std::cout << "WRITE FAILED\n";
+        return 2;
+    }
+
+    // Best of several runs (the file is in the page cache after the first one)
+    double loadTime(0.0);
+    Behavior::Program loaded;
+    for (std::size_t run = 0; run < 10; ++run)
+    {
+        std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        loaded = Behavior::loadProgram(fileName);
+        const double time(millisecondsSince(start));
+        loadTime = run ? std::min(loadTime, time) : time;
+    }
+    std::remove(fileName.c_str());
+
+    const std::string model(Behavior::exportNetlist(netlist));
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    YAML::Node doc(YAML::Load(model));
+    const double parseTime(millisecondsSince(start));
+
+    // Check
+    Behavior::Evaluator original(program);
+    Behavior::Evaluator restored(loaded);
+    double maxError(loaded.empty() ? 1.0 : 0.0);
+    for (std::size_t t = 0; !loaded.empty() && (t < 10); ++t)
+    {
+        for (std::size_t i = 0; i < program.inputNames.size(); ++i)
+        {
+            original.setInput(i, std::sin(0.1 * t + i));
+            restored.setInput(i, std::sin(0.1 * t + i));
+        }
+        original.step();
+        restored.step();
+        for (std::size_t o = 0; o < program.outputNames.size(); ++o)
+            maxError = std::max(maxError, std::fabs(original.getOutput(o) - restored.getOutput(o)));
+    }
+
+    std::cout << "Model: " << program.nodes() << " nodes, " << program.merges() << " merges, " << program.edges() << " edges\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Binary load:\t" << loadTime << " ms (" << Behavior::serializeProgram(program).size() / 1024 << " KiB)\n";
+    std::cout << "YAML parse:\t" << parseTime << " ms (" << model.size() / 1024 << " KiB, " << doc["nodes"].size() << " nodes)\n";
+    std::cout << "Max. difference:\t" << std::scientific << maxError << "\n";
+    return maxError == 0.0 ? 0 : 1;
+}
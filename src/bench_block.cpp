@@ -0,0 +1,159 @@
+#include "BehaviorEvaluator.hpp"
+#include "BehaviorBlockEvaluator.hpp"
+#include "benchmark_models.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"samples", required_argument, 0, 's'},
+    {"stages", required_argument, 0, 'p'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--samples=<n>] [--stages=<n>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--samples=<n>\t" << "Number of samples to measure per block size (default: 1000000)\n";
+    std::cout << "--stages=<n>\t" << "Number of allpass stages of the phaser model (default: 8)\n";
+    std::cout << "\nMeasures the throughput of the BlockEvaluator for several block sizes against the Evaluator (one sample per step)\n";
+    std::cout << "on a phaser model (see benchmark_models.hpp) and on a layered model without cycles.\n";
+    std::cout << "Returns 0 if all block sizes produce the same outputs as the Evaluator.\n";
+}
+
+static double inputAt(const std::size_t t)
+{
+    return std::sin(0.01 * t) + 0.25 * std::sin(0.37 * t);
+}
+
+// Returns the maximum difference of the outputs of a block size against the Evaluator
+static double compare(const Behavior::Program& program, const std::size_t blockSize)
+{
+    Behavior::Evaluator eval(program, Behavior::SimdLevel::SCALAR);
+    Behavior::BlockEvaluator block(program, blockSize);
+    double maxError(0.0);
+    for (std::size_t b = 0; b < 4; ++b)
+    {
+        for (std::size_t i = 0; i < program.inputNames.size(); ++i)
+        {
+            for (std::size_t t = 0; t < blockSize; ++t)
+                block.inputBlock(i)[t] = inputAt(b * blockSize + t + i);
+        }
+        block.process();
+        for (std::size_t t = 0; t < blockSize; ++t)
+        {
+            for (std::size_t i = 0; i < program.inputNames.size(); ++i)
+                eval.setInput(i, inputAt(b * blockSize + t + i));
+            eval.step();
+            for (std::size_t o = 0; o < program.outputNames.size(); ++o)
+                maxError = std::max(maxError, std::fabs(eval.getOutput(o) - block.outputBlock(o)[t]));
+        }
+    }
+    return maxError;
+}
+
+// Returns the samples per second of the Evaluator
+static double measureSteps(const Behavior::Program& program, const std::size_t samples, double& sink)
+{
+    Behavior::Evaluator eval(program, Behavior::SimdLevel::SCALAR);
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    for (std::size_t t = 0; t < samples; ++t)
+    {
+        eval.setInput(0, 1e-3 * (t % 1000));
+        eval.step();
+        sink += eval.getOutput(0);
+    }
+    return samples / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Returns the samples per second of the BlockEvaluator
+static double measureBlocks(const Behavior::Program& program, const std::size_t blockSize, const std::size_t samples, double& sink)
+{
+    Behavior::BlockEvaluator block(program, blockSize);
+    const std::size_t blocks(std::max<std::size_t>(samples / blockSize, 1));
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    for (std::size_t b = 0; b < blocks; ++b)
+    {
+        double* in(block.inputBlock(0));
+        for (std::size_t t = 0; t < blockSize; ++t)
+            in[t] = 1e-3 * ((b * blockSize + t) % 1000);
+        block.process();
+        const double* out(block.outputBlock(0));
+        for (std::size_t t = 0; t < blockSize; ++t)
+            sink += out[t];
+    }
+    return blocks * blockSize / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main (int argc, char **argv)
+{
+    std::size_t samples(1000000);
+    std::size_t stages(8);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hs:p:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 's':
+                samples = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                stages = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    const std::size_t blockSizes[] = {1, 8, 32, 128, 512};
+    Behavior::Netlist layered(layeredModel(16, 8, 3, 1));
+    // Without the feedback edges, all nodes are processed block-wise
+    for (Behavior::Netlist::Node& node : layered.nodes)
+    {
+        for (Behavior::Netlist::Merge& merge : node.inputs)
+            merge.edges.resize(std::min<std::size_t>(merge.edges.size(), 3));
+    }
+    const Behavior::Program programs[] = {Behavior::Program(phaserModel(stages)), Behavior::Program(layered)};
+
+    double sink(0.0);
+    double maxError(0.0);
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Behavior::Program& program : programs)
+    {
+        const Behavior::BlockEvaluator info(program, 1);
+        std::cout << "Model " << program.name << ": " << program.nodes() << " nodes (" << info.cyclicNodes() << " in cycles), "
+                  << program.edges() << " edges\n";
+        const double stepRate(measureSteps(program, samples, sink));
+        std::cout << "Evaluator:\t" << stepRate / 1e6 << " Msamples/s\n";
+        for (const std::size_t blockSize : blockSizes)
+        {
+            const double error(compare(program, blockSize));
+            const double blockRate(measureBlocks(program, blockSize, samples, sink));
+            maxError = std::max(maxError, error);
+            std::cout << "Block of " << blockSize << ":\t" << blockRate / 1e6 << " Msamples/s (" << blockRate / stepRate << "x)"
+                      << std::scientific << "\tmax. difference " << error << std::fixed << "\n";
+        }
+    }
+    std::cout << "(" << sink << ")\n";
+    return maxError == 0.0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include "BehaviorEvaluator.hpp"
+#include "benchmark_models.hpp"
+#include "bench_model.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"steps", required_argument, 0, 's'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--steps=<n>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--steps=<n>\t" << "Number of steps to measure (default: 10000)\n";
+    std::cout << "\nCompares the generated code (see bg-generate-cpp) against the Evaluator (SimdLevel::SCALAR) on a synthetic model.\n";
+    std::cout << "Returns 0 if both produce the same outputs bit for bit.\n";
+}
+
+int main (int argc, char **argv)
+{
+    std::size_t steps(10000);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hs:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 's':
+                steps = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    // The same model the header has been generated from
+    const Behavior::Program program(layeredModel(64, 16));
+    Behavior::Evaluator eval(program, Behavior::SimdLevel::SCALAR);
+    bench_model::State state;
+    bench_model::reset(state);
+    double in[bench_model::inputs];
+    double out[bench_model::outputs];
+
+    // Check
+    double maxError(0.0);
+    std::size_t mismatches(0);
+    for (std::size_t t = 0; t < 100; ++t)
+    {
+        for (std::size_t i = 0; i < bench_model::inputs; ++i)
+        {
+            in[i] = std::sin(0.1 * t + i);
+            eval.setInput(i, in[i]);
+        }
+        eval.step();
+        bench_model::step(state, in, out);
+        for (std::size_t o = 0; o < bench_model::outputs; ++o)
+        {
+            maxError = std::max(maxError, std::fabs(eval.getOutput(o) - out[o]));
+            if ((eval.getOutput(o) != out[o]) && !(std::isnan(eval.getOutput(o)) && std::isnan(out[o])))
+                mismatches++;
+        }
+    }
+
+    // Measure
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    for (std::size_t t = 0; t < steps; ++t)
+    {
+        eval.setInput(0, 1e-3 * t);
+        eval.step();
+    }
+    const double evalTime(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    double sink(eval.getOutput(0));
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < steps; ++t)
+    {
+        in[0] = 1e-3 * t;
+        bench_model::step(state, in, out);
+    }
+    const double generatedTime(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    sink += out[0];
+
+    std::cout << "Model: " << program.nodes() << " nodes, " << program.merges() << " merges, " << program.edges() << " edges\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Evaluator:\t" << evalTime / steps << " ns/step\n";
+    std::cout << "Generated:\t" << generatedTime / steps << " ns/step\n";
+    std::cout << "Speedup:\t" << std::setprecision(2) << evalTime / generatedTime << "x\n";
+    std::cout << "Max. difference:\t" << std::scientific << maxError << " (" << sink << ")\n";
+    std::cout << "Mismatches:\t" << mismatches << "\n";
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#include "BehaviorCodegen.hpp"
+#include "benchmark_models.hpp"
+
+#include <iostream>
+#include <fstream>
+
+// Generates the code of the models used by bg-bench-codegen and bg-bench-static (see benchmark_models.hpp)
+int main (int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage:\n" << argv[0] << " <header-file-out> <static-header-file-out>\n";
+        return 1;
+    }
+
+    std::ofstream fout(argv[1]);
+    std::ofstream staticOut(argv[2]);
+    if(!fout.good() || !staticOut.good()) {
+        std::cout << "WRITE FAILED\n";
+        return 2;
+    }
+    fout << Behavior::generateCpp(Behavior::Program(layeredModel(64, 16)), "bench_model");
+    staticOut << Behavior::generateStaticCpp(Behavior::Program(layeredModel(8, 4)), "bench_static_model");
+    return 0;
+}
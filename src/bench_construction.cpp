@@ -0,0 +1,74 @@
+#include "BehaviorGraph.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"count", required_argument, 0, 'c'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--count=<n>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--count=<n>\t" << "Number of graphs constructed per case (default: 1000)\n";
+    std::cout << "\nMeasures how long it takes to construct a Behavior::Graph:\n";
+    std::cout << "From scratch (the meta model is created), from the shared meta model and as a copy of another graph.\n";
+}
+
+// Average time of constructing and destroying a graph in microseconds
+template<typename Construct> static double microsecondsPer(const std::size_t count, Construct construct)
+{
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    for (std::size_t i = 0; i < count; ++i)
+        construct();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+int main (int argc, char **argv)
+{
+    std::size_t count(1000);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hc:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'c':
+                count = std::stoul(optarg);
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    // Build the meta model before measuring
+    const Behavior::Graph original;
+    const Hypergraph empty;
+    const double scratch(microsecondsPer(count, [&empty]() { Behavior::Graph bg(empty); }));
+    const double shared(microsecondsPer(count, []() { Behavior::Graph bg; }));
+    const double copied(microsecondsPer(count, [&original]() { Behavior::Graph bg(original); }));
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "From scratch:\t" << scratch << " us\n";
+    std::cout << "Meta model:\t" << shared << " us (" << scratch / shared << "x)\n";
+    std::cout << "Copy:\t\t" << copied << " us\n";
+    return 0;
+}
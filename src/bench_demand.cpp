@@ -0,0 +1,154 @@
+#include "BehaviorEvaluator.hpp"
+#include "benchmark_models.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"steps", required_argument, 0, 's'},
+    {"width", required_argument, 0, 'w'},
+    {"depth", required_argument, 0, 'd'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--steps=<n>] [--width=<n>] [--depth=<n>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--steps=<n>\t" << "Number of steps to measure (default: 10000)\n";
+    std::cout << "--width=<n>\t" << "Nodes per layer (and outputs) of the neural model (default: 256)\n";
+    std::cout << "--depth=<n>\t" << "Number of layers of the neural model (default: 4)\n";
+    std::cout << "\nMeasures demand-driven steps (see Evaluator::demand) reading 1, 8 and all outputs of a sparse neural model\n";
+    std::cout << "(see benchmark_models.hpp) against full steps.\n";
+    std::cout << "Returns 0 if the requested outputs agree with those of full steps (up to rounding)\n";
+    std::cout << "and the other outputs keep their values (also if layers are evaluated in bulk).\n";
+}
+
+int main (int argc, char **argv)
+{
+    std::size_t steps(10000);
+    std::size_t width(256);
+    std::size_t depth(4);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hs:w:d:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 's':
+                steps = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                width = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                depth = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    const Behavior::Program program(neuralModel(width, depth, 4));
+    std::cout << "Model " << program.name << ": " << program.nodes() << " nodes, " << program.edges() << " edges\n";
+    std::cout << std::fixed << std::setprecision(1);
+
+    double sink(0.0);
+    double maxError(0.0);
+    double fullRate(0.0);
+    const std::size_t requests[] = {0, 1, 8, program.outputNames.size()};
+    for (const std::size_t count : requests)
+    {
+        // No request means full steps
+        Behavior::Evaluator full(program);
+        Behavior::Evaluator eval(program);
+        std::vector<std::size_t> outputs;
+        for (std::size_t o = 0; o < std::min(count, program.outputNames.size()); ++o)
+            outputs.push_back(o);
+        const std::size_t schedule(eval.demand(outputs));
+        std::vector<bool> demanded(program.demandOf(outputs));
+
+        std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        for (std::size_t t = 0; t < steps; ++t)
+        {
+            for (std::size_t i = 0; i < program.inputNames.size(); ++i)
+                eval.setInput(i, std::sin(1e-3 * t + i));
+            if (count)
+                eval.step(schedule);
+            else
+                eval.step();
+            sink += eval.getOutput(0);
+        }
+        const double rate(steps / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        // Check against full steps
+        for (std::size_t t = 0; t < steps; ++t)
+        {
+            for (std::size_t i = 0; i < program.inputNames.size(); ++i)
+                full.setInput(i, std::sin(1e-3 * t + i));
+            full.step();
+        }
+        double error(0.0);
+        for (const std::size_t o : outputs)
+            error = std::max(error, std::fabs(full.getOutput(o) - eval.getOutput(o)));
+        maxError = std::max(maxError, error);
+
+        if (!count)
+        {
+            fullRate = rate;
+            std::cout << "Full steps:\t" << rate << " steps/s\n";
+            continue;
+        }
+        std::size_t nodes(0);
+        for (const bool d : demanded)
+            nodes += d;
+        std::cout << count << " outputs:\t" << rate << " steps/s (" << std::setprecision(2) << rate / fullRate << "x, "
+                  << nodes << " nodes)" << std::scientific << "\tmax. difference " << error << std::fixed << std::setprecision(1) << "\n";
+    }
+
+    // All outputs but the last one make the output layer mostly needed, so it is evaluated in bulk (see Evaluator::step)
+    double drift(0.0);
+    const Behavior::Feedback feedbacks[] = {Behavior::Feedback::IN_PLACE, Behavior::Feedback::DOUBLE_BUFFERED};
+    for (const Behavior::Feedback feedback : feedbacks)
+    {
+        const Behavior::Program buffered(neuralModel(width, depth, 4), Behavior::Precision::EXACT, feedback);
+        Behavior::Evaluator eval(buffered, Behavior::detectSimdLevel(), true);
+        std::vector<std::size_t> outputs;
+        for (std::size_t o = 0; o + 1 < buffered.outputNames.size(); ++o)
+            outputs.push_back(o);
+        const std::size_t schedule(eval.demand(outputs));
+        for (std::size_t i = 0; i < buffered.inputNames.size(); ++i)
+            eval.setInput(i, 1.0);
+        eval.step();
+        const double last(eval.getOutput(buffered.outputNames.size() - 1));
+        for (std::size_t t = 0; t < 100; ++t)
+        {
+            for (std::size_t i = 0; i < buffered.inputNames.size(); ++i)
+                eval.setInput(i, std::sin(1e-1 * t + i));
+            eval.step(schedule);
+            drift = std::max(drift, std::fabs(eval.getOutput(buffered.outputNames.size() - 1) - last));
+        }
+    }
+    std::cout << "Drift of the outputs not requested:\t" << std::scientific << drift << "\n";
+
+    std::cout << "(" << sink << ")\n";
+    return ((maxError < 1e-9) && (drift == 0.0)) ? 0 : 1;
+}
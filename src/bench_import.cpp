@@ -0,0 +1,86 @@
+#include "BehaviorGraph.hpp"
+#include "benchmark_models.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <sstream>
+#include <chrono>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"sizes", required_argument, 0, 's'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--sizes=<n,...>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--sizes=<n,...>\t" << "Number of nodes of the synthetic models (default: 1000,10000,100000)\n";
+    std::cout << "\nMeasures how long Graph::importModel takes for synthetic models of increasing size.\n";
+    std::cout << "The time per node should stay the same.\n";
+}
+
+int main (int argc, char **argv)
+{
+    std::string sizes("1000,10000,100000");
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hs:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 's':
+                sizes = optarg;
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    std::cout << "nodes\tedges\timport [s]\tper node [us]\n";
+    std::stringstream ss(sizes);
+    std::string size;
+    while (std::getline(ss, size, ','))
+    {
+        // Layers of 100 nodes
+        const std::size_t depth(std::max<std::size_t>(1, std::stoul(size) / 100));
+        const Behavior::Netlist netlist(layeredModel(100, depth));
+        const std::string model(Behavior::exportNetlist(netlist));
+        std::size_t edges(0);
+        for (const Behavior::Netlist::Node& node : netlist.nodes)
+        {
+            for (const Behavior::Netlist::Merge& merge : node.inputs)
+                edges += merge.edges.size();
+        }
+
+        Behavior::Graph bg;
+        std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        const UniqueId uid(bg.importModel(model));
+        const double seconds(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        if (uid.empty())
+        {
+            std::cout << "Could not import " << netlist.name << "\n";
+            return 2;
+        }
+
+        std::cout << netlist.nodes.size() << "\t" << edges << "\t" << std::fixed << std::setprecision(3) << seconds << "\t\t"
+                  << std::setprecision(1) << 1e6 * seconds / netlist.nodes.size() << "\n";
+    }
+    return 0;
+}
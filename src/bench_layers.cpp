@@ -0,0 +1,127 @@
+#include "BehaviorEvaluator.hpp"
+#include "benchmark_models.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"steps", required_argument, 0, 's'},
+    {"width", required_argument, 0, 'w'},
+    {"depth", required_argument, 0, 'd'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--steps=<n>] [--width=<n>] [--depth=<n>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--steps=<n>\t" << "Number of steps to measure (default: 2000)\n";
+    std::cout << "--width=<n>\t" << "Nodes per layer of the neural models (default: 256)\n";
+    std::cout << "--depth=<n>\t" << "Number of layers of the neural models (default: 8)\n";
+    std::cout << "\nMeasures the Evaluator with and without layers (see BehaviorLayers.hpp) on neural models of increasing fan-in\n";
+    std::cout << "(see benchmark_models.hpp), from sparse (CSR) to fully connected (dense) layers.\n";
+    std::cout << "Returns 0 if the outputs of both agree up to rounding.\n";
+}
+
+// Returns the steps per second of an evaluator
+static double measure(Behavior::Evaluator& eval, const std::size_t steps, double& sink)
+{
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    for (std::size_t t = 0; t < steps; ++t)
+    {
+        eval.setInput(0, 1e-3 * (t % 1000));
+        eval.step();
+        sink += eval.getOutput(0);
+    }
+    return steps / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main (int argc, char **argv)
+{
+    std::size_t steps(2000);
+    std::size_t width(256);
+    std::size_t depth(8);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hs:w:d:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 's':
+                steps = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                width = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                depth = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    const std::size_t fanIns[] = {4, 16, width / 8, width / 2, width};
+    double sink(0.0);
+    double maxError(0.0);
+    for (const std::size_t fanIn : fanIns)
+    {
+        const Behavior::Program program(neuralModel(width, depth, std::max<std::size_t>(fanIn, 1)));
+        Behavior::Evaluator generic(program);
+        Behavior::Evaluator layered(program, Behavior::detectSimdLevel(), true);
+        std::size_t layerNodes(0);
+        std::size_t denseLayers(0);
+        for (const Behavior::Layer& layer : layered.layerPlan().layers)
+        {
+            layerNodes += layer.nodeEnd - layer.nodeBegin;
+            if (layer.dense)
+                denseLayers++;
+        }
+
+        // Check
+        double error(0.0);
+        for (std::size_t t = 0; t < 100; ++t)
+        {
+            for (std::size_t i = 0; i < program.inputNames.size(); ++i)
+            {
+                generic.setInput(i, std::sin(0.1 * t + i));
+                layered.setInput(i, std::sin(0.1 * t + i));
+            }
+            generic.step();
+            layered.step();
+            for (std::size_t o = 0; o < program.outputNames.size(); ++o)
+                error = std::max(error, std::fabs(generic.getOutput(o) - layered.getOutput(o)));
+        }
+        maxError = std::max(maxError, error);
+
+        // Measure
+        const double genericRate(measure(generic, steps, sink));
+        const double layeredRate(measure(layered, steps, sink));
+        std::cout << "Model " << program.name << ": " << program.nodes() << " nodes, " << program.edges() << " edges, "
+                  << layered.layerPlan().layers.size() << " layers (" << denseLayers << " dense) of " << layerNodes << " nodes\n";
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Generic:\t" << genericRate << " steps/s\n";
+        std::cout << "Layers:\t\t" << layeredRate << " steps/s (" << std::setprecision(2) << layeredRate / genericRate << "x)"
+                  << std::scientific << "\tmax. difference " << error << "\n";
+    }
+    std::cout << "(" << sink << ")\n";
+    return maxError < 1e-9 ? 0 : 1;
+}
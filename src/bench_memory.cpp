@@ -0,0 +1,156 @@
+#include "BehaviorProgram.hpp"
+#include "benchmark_models.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"instances", required_argument, 0, 'i'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--instances=<n>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--instances=<n>\t" << "Number of SUBGRAPH instances of the synthetic model (default: 100)\n";
+    std::cout << "\nCompares the memory held by the names and uids of a compiled program when stored as strings and as symbols.\n";
+    std::cout << "The model consists of instances of one SUBGRAPH, so like every flattened model it repeats the uids of the SUBGRAPH.\n";
+}
+
+// A uid like the ones of the hypergraph
+static UniqueId uidOf(const std::string& kind, std::mt19937& rng)
+{
+    unsigned parts[6];
+    for (unsigned& part : parts)
+        part = rng();
+    char id[40];
+    std::snprintf(id, sizeof(id), "%08x-%04x-%04x-%04x-%08x%04x", parts[0], parts[1] & 0xffff, parts[2] & 0xffff, parts[3] & 0xffff, parts[4], parts[5] & 0xffff);
+    return "Behavior::Graph::" + kind + "::" + id;
+}
+
+// Heap memory of a vector of strings (short strings are stored inside std::string)
+static std::size_t heapOf(const std::vector<std::string>& strings)
+{
+    std::size_t result(strings.capacity() * sizeof(std::string));
+    for (const std::string& text : strings)
+    {
+        if (text.capacity() > std::string().capacity())
+            result += text.capacity() + 1;
+    }
+    return result;
+}
+
+// The names and uids stored as strings (as they would be without the symbol table)
+static std::size_t stringBytesOf(const Behavior::Program& program)
+{
+    const Behavior::Symbols* lists[] = {&program.inputNames, &program.outputNames, &program.nodeNames,
+                                        &program.nodeUids, &program.mergeUids, &program.edgeUids};
+    std::size_t result(0);
+    for (const Behavior::Symbols* list : lists)
+    {
+        std::vector<std::string> strings;
+        strings.reserve(list->size());
+        for (const Behavior::Symbol symbol : *list)
+            strings.push_back(program.symbols.str(symbol));
+        result += heapOf(strings);
+    }
+    return result;
+}
+
+static std::size_t symbolBytesOf(const Behavior::Program& program)
+{
+    const std::size_t entries(program.inputNames.capacity() + program.outputNames.capacity() + program.nodeNames.capacity() +
+                              program.nodeUids.capacity() + program.mergeUids.capacity() + program.edgeUids.capacity());
+    return entries * sizeof(Behavior::Symbol) + program.symbols.bytes();
+}
+
+int main (int argc, char **argv)
+{
+    std::size_t instances(100);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hi:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'i':
+                instances = std::stoul(optarg);
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    // The SUBGRAPH
+    using namespace Behavior;
+    std::mt19937 rng(1);
+    Netlist body(layeredModel(20, 10));
+    for (Netlist::Node& node : body.nodes)
+    {
+        node.uid = uidOf("Node", rng);
+        for (Netlist::Merge& merge : node.inputs)
+        {
+            merge.uid = uidOf("Merge", rng);
+            for (Netlist::Edge& edge : merge.edges)
+                edge.uid = uidOf("Edge", rng);
+        }
+    }
+
+    // The model: every instance reads all inputs and drives one output
+    Netlist model;
+    model.name = "instances";
+    std::vector<const Netlist*> bodies;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        model.nodes.push_back(Netlist::Node{NodeOp::INPUT, "in" + std::to_string(i), uidOf("Node", rng), "", {}, {}, {"0"}});
+        bodies.push_back(NULL);
+    }
+    for (std::size_t k = 0; k < instances; ++k)
+    {
+        Netlist::Node node{NodeOp::SUBGRAPH, "instance" + std::to_string(k), uidOf("Node", rng), "", {}, {}, {"out0"}};
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            node.inputNames.push_back("in" + std::to_string(i));
+            node.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.0, 0.0, {Netlist::Edge{i, 0, 1.0, uidOf("Edge", rng), false}}, uidOf("Merge", rng)});
+        }
+        model.nodes.push_back(node);
+        bodies.push_back(&body);
+    }
+    for (std::size_t k = 0; k < instances; ++k)
+    {
+        Netlist::Node node{NodeOp::OUTPUT, "out" + std::to_string(k), uidOf("Node", rng), "", {"0"}, {}, {"0"}};
+        node.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.0, 0.0, {Netlist::Edge{4 + k, 0, 1.0, uidOf("Edge", rng), false}}, uidOf("Merge", rng)});
+        model.nodes.push_back(node);
+        bodies.push_back(NULL);
+    }
+
+    const Program program(inlineSubgraphs(model, bodies));
+    const std::size_t entities(program.nodes() + program.merges() + program.edges());
+    const std::size_t strings(stringBytesOf(program));
+    const std::size_t symbols(symbolBytesOf(program));
+
+    std::cout << "Model: " << program.nodes() << " nodes, " << program.merges() << " merges, " << program.edges() << " edges ("
+              << program.symbols.size() << " distinct names and uids)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Strings:\t" << strings / 1024 << " KiB (" << static_cast<double>(strings) / entities << " bytes per node/merge/edge)\n";
+    std::cout << "Symbols:\t" << symbols / 1024 << " KiB (" << static_cast<double>(symbols) / entities << " bytes per node/merge/edge)\n";
+    std::cout << "Saved:\t\t" << 100.0 * (1.0 - static_cast<double>(symbols) / strings) << " %\n";
+    return 0;
+}
@@ -0,0 +1,150 @@
+#ifndef _BEHAVIOUR_BENCHMARK_MODELS_HPP
+#define _BEHAVIOUR_BENCHMARK_MODELS_HPP
+
+#include "BehaviorNetlist.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+/*
+    Synthetic models used by the benchmarks (not part of the library).
+
+    A layered model has 'width' nodes per layer and 'depth' layers. Every node reads 'fanIn' random nodes
+    of the previous layer (the first layer reads the inputs) and every tenth merge also gets a feedback edge
+    from a random node of any layer. The nodes of the last layer are the outputs.
+    The same seed always yields the same model.
+
+    A phaser model is a chain of first order allpass filters (y = -g x + x' + g y', where ' is the previous step)
+    fed by one INPUT, mixed with the dry signal and shaped by a chain of 'shapers' nodes without feedback.
+
+    A neural model has 'depth' layers of 'width' TANH nodes, every node reads 'fanIn' distinct random nodes of the previous layer
+    (the first layer reads the inputs) by a SUM merge with a random bias. The last layer feeds the OUTPUT nodes.
+*/
+inline Behavior::Netlist layeredModel(const std::size_t width, const std::size_t depth, const std::size_t fanIn = 3,
+                                      const std::size_t inputs = 4, const unsigned seed = 1)
+{
+    using namespace Behavior;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> weight(-1.0, 1.0);
+    const NodeOp ops[] = {NodeOp::TANH, NodeOp::SIN, NodeOp::PIPE, NodeOp::ATAN, NodeOp::ABS, NodeOp::GREATER_ZERO};
+    const MergeOp merges[] = {MergeOp::SUM, MergeOp::SUM, MergeOp::SUM, MergeOp::PRODUCT, MergeOp::MAX, MergeOp::MEAN};
+
+    Netlist netlist;
+    netlist.name = "layered_" + std::to_string(width) + "x" + std::to_string(depth);
+    for (std::size_t i = 0; i < inputs; ++i)
+        netlist.nodes.push_back(Netlist::Node{NodeOp::INPUT, "in" + std::to_string(i), "", "", {}, {}, {"0"}});
+
+    for (std::size_t d = 0; d < depth; ++d)
+    {
+        const std::size_t first(d ? inputs + (d - 1) * width : 0);
+        const std::size_t count(d ? width : inputs);
+        for (std::size_t w = 0; w < width; ++w)
+        {
+            const NodeOp op(ops[rng() % (sizeof(ops) / sizeof(ops[0]))]);
+            Netlist::Node node{op, "n" + std::to_string(d) + "_" + std::to_string(w), "", "", {}, {}, {"0"}};
+            for (std::size_t i = 0; i < arityOf(op); ++i)
+            {
+                Netlist::Merge merge{merges[rng() % (sizeof(merges) / sizeof(merges[0]))], 0.1 * weight(rng), 0.0, {}, ""};
+                for (std::size_t e = 0; e < fanIn; ++e)
+                    merge.edges.push_back(Netlist::Edge{first + rng() % count, 0, weight(rng), "", false});
+                if (rng() % 10 == 0)
+                    merge.edges.push_back(Netlist::Edge{inputs + rng() % (depth * width), 0, 0.5 * weight(rng), "", false});
+                node.inputNames.push_back(std::to_string(i));
+                node.inputs.push_back(merge);
+            }
+            netlist.nodes.push_back(node);
+        }
+    }
+
+    const std::size_t last(inputs + (depth - 1) * width);
+    for (std::size_t w = 0; w < width; ++w)
+    {
+        Netlist::Node node{NodeOp::OUTPUT, "out" + std::to_string(w), "", "", {"0"}, {}, {"0"}};
+        node.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.0, 0.0, {Netlist::Edge{last + w, 0, 1.0, "", false}}, ""});
+        netlist.nodes.push_back(node);
+    }
+    return netlist;
+}
+
+inline Behavior::Netlist phaserModel(const std::size_t stages, const std::size_t shapers = 8)
+{
+    using namespace Behavior;
+    const NodeOp ops[] = {NodeOp::TANH, NodeOp::SIN, NodeOp::ATAN, NodeOp::ABS};
+
+    Netlist netlist;
+    netlist.name = "phaser_" + std::to_string(stages);
+    netlist.nodes.push_back(Netlist::Node{NodeOp::INPUT, "audio_in", "", "", {}, {}, {"0"}});
+    std::size_t last(0);
+    for (std::size_t s = 0; s < stages; ++s)
+    {
+        const double g(0.2 + 0.6 * s / stages);
+        const std::size_t self(netlist.nodes.size());
+        Netlist::Node node{NodeOp::PIPE, "allpass" + std::to_string(s), "", "", {"0"}, {}, {"0"}};
+        node.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.0, 0.0, {Netlist::Edge{last, 0, -g, "", false},
+                                                                      Netlist::Edge{last, 0, 1.0, "", true},
+                                                                      Netlist::Edge{self, 0, g, "", true}}, ""});
+        netlist.nodes.push_back(node);
+        last = self;
+    }
+
+    Netlist::Node mix{NodeOp::PIPE, "mix", "", "", {"0"}, {}, {"0"}};
+    mix.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.0, 0.0, {Netlist::Edge{0, 0, 0.5, "", false}, Netlist::Edge{last, 0, 0.5, "", false}}, ""});
+    netlist.nodes.push_back(mix);
+    for (std::size_t s = 0; s < shapers; ++s)
+    {
+        last = netlist.nodes.size() - 1;
+        Netlist::Node node{ops[s % (sizeof(ops) / sizeof(ops[0]))], "shaper" + std::to_string(s), "", "", {"0"}, {}, {"0"}};
+        node.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.01, 0.0, {Netlist::Edge{last, 0, 1.5, "", false}}, ""});
+        netlist.nodes.push_back(node);
+    }
+
+    Netlist::Node out{NodeOp::OUTPUT, "audio_out", "", "", {"0"}, {}, {"0"}};
+    out.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.0, 0.0, {Netlist::Edge{netlist.nodes.size() - 1, 0, 1.0, "", false}}, ""});
+    netlist.nodes.push_back(out);
+    return netlist;
+}
+
+inline Behavior::Netlist neuralModel(const std::size_t width, const std::size_t depth, const std::size_t fanIn,
+                                     const std::size_t inputs = 16, const unsigned seed = 1)
+{
+    using namespace Behavior;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> weight(-1.0, 1.0);
+
+    Netlist netlist;
+    netlist.name = "neural_" + std::to_string(width) + "x" + std::to_string(depth) + "_" + std::to_string(fanIn);
+    for (std::size_t i = 0; i < inputs; ++i)
+        netlist.nodes.push_back(Netlist::Node{NodeOp::INPUT, "in" + std::to_string(i), "", "", {}, {}, {"0"}});
+
+    std::vector<std::size_t> previous;
+    for (std::size_t i = 0; i < inputs; ++i)
+        previous.push_back(i);
+    for (std::size_t d = 0; d < depth; ++d)
+    {
+        std::vector<std::size_t> layer;
+        for (std::size_t w = 0; w < width; ++w)
+        {
+            Netlist::Node node{NodeOp::TANH, "n" + std::to_string(d) + "_" + std::to_string(w), "", "", {"0"}, {}, {"0"}};
+            Netlist::Merge merge{MergeOp::SUM, 0.1 * weight(rng), 0.0, {}, ""};
+            std::shuffle(previous.begin(), previous.end(), rng);
+            for (std::size_t e = 0; e < std::min(fanIn, previous.size()); ++e)
+                merge.edges.push_back(Netlist::Edge{previous[e], 0, weight(rng) / std::sqrt(static_cast<double>(fanIn)), "", false});
+            node.inputs.push_back(merge);
+            layer.push_back(netlist.nodes.size());
+            netlist.nodes.push_back(node);
+        }
+        previous = layer;
+    }
+
+    for (std::size_t w = 0; w < previous.size(); ++w)
+    {
+        Netlist::Node node{NodeOp::OUTPUT, "out" + std::to_string(w), "", "", {"0"}, {}, {"0"}};
+        node.inputs.push_back(Netlist::Merge{MergeOp::SUM, 0.0, 0.0, {Netlist::Edge{previous[w], 0, 1.0, "", false}}, ""});
+        netlist.nodes.push_back(node);
+    }
+    return netlist;
+}
+
+#endif
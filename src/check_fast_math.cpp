@@ -0,0 +1,179 @@
+#include "BehaviorFastMath.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"samples", required_argument, 0, 'n'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [--samples=<n>]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--samples=<n>\t" << "Number of samples per sweep (default: 1000000)\n";
+    std::cout << "\nCompares the fast math approximations against libm on dense sweeps.\n";
+    std::cout << "The batch functions (used for whole layers and blocks) have to yield the same bits as the scalar ones (used node by node).\n";
+    std::cout << "Returns 0 if all errors are within the bounds of the selected precisions and both agree.\n";
+}
+
+typedef double (*Reference)(const double, const double);
+typedef void (*Unary)(const double*, double*, const std::size_t, const Behavior::Precision);
+typedef void (*Binary)(const double*, const double*, double*, const std::size_t, const Behavior::Precision);
+
+struct Sweep
+{
+    const char* name;
+    Reference reference;
+    Unary unary;
+    Binary binary;
+    // The scalar functions for HIGH and LOW precision
+    Reference scalar[2];
+    double xMin, xMax;
+    double yMin, yMax;
+    bool relative;
+};
+
+static double refSin(const double x, const double) { return std::sin(x); }
+static double refCos(const double x, const double) { return std::cos(x); }
+static double refTanh(const double x, const double) { return std::tanh(x); }
+static double refExp(const double x, const double) { return std::exp(x); }
+static double refLog(const double x, const double) { return std::log(x); }
+static double refAtan(const double x, const double) { return std::atan(x); }
+static double refAtan2(const double y, const double x) { return std::atan2(y, x); }
+static double refPow(const double x, const double y) { return std::pow(x, y); }
+
+template<Behavior::Precision P> static double fastSin(const double x, const double) { return Behavior::FastMath::sin<P>(x); }
+template<Behavior::Precision P> static double fastCos(const double x, const double) { return Behavior::FastMath::cos<P>(x); }
+template<Behavior::Precision P> static double fastTanh(const double x, const double) { return Behavior::FastMath::tanh<P>(x); }
+template<Behavior::Precision P> static double fastExp(const double x, const double) { return Behavior::FastMath::exp<P>(x); }
+template<Behavior::Precision P> static double fastLog(const double x, const double) { return Behavior::FastMath::log<P>(x); }
+template<Behavior::Precision P> static double fastAtan(const double x, const double) { return Behavior::FastMath::atan<P>(x); }
+template<Behavior::Precision P> static double fastAtan2(const double y, const double x) { return Behavior::FastMath::atan2<P>(y, x); }
+template<Behavior::Precision P> static double fastPow(const double x, const double y) { return Behavior::FastMath::pow<P>(x, y); }
+
+#define BEHAVIOR_SCALAR(f) {f<Behavior::Precision::HIGH>, f<Behavior::Precision::LOW>}
+
+int main (int argc, char **argv)
+{
+    std::size_t samples(1000000);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hn:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'n':
+                samples = std::strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+            case '?':
+                usage(argv[0]);
+                return 0;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    const Sweep sweeps[] = {
+        {"SIN", refSin, Behavior::FastMath::sin, NULL, BEHAVIOR_SCALAR(fastSin), -100.0, 100.0, 0.0, 0.0, false},
+        {"COS", refCos, Behavior::FastMath::cos, NULL, BEHAVIOR_SCALAR(fastCos), -100.0, 100.0, 0.0, 0.0, false},
+        {"TANH", refTanh, Behavior::FastMath::tanh, NULL, BEHAVIOR_SCALAR(fastTanh), -25.0, 25.0, 0.0, 0.0, false},
+        // Up to overflow and through the subnormals down to underflow
+        {"EXP", refExp, Behavior::FastMath::exp, NULL, BEHAVIOR_SCALAR(fastExp), -746.0, 711.0, 0.0, 0.0, true},
+        {"LOG", refLog, Behavior::FastMath::log, NULL, BEHAVIOR_SCALAR(fastLog), 1e-300, 1e300, 0.0, 0.0, false},
+        {"LOG", refLog, Behavior::FastMath::log, NULL, BEHAVIOR_SCALAR(fastLog), 1e-3, 10.0, 0.0, 0.0, false},
+        {"ATAN", refAtan, Behavior::FastMath::atan, NULL, BEHAVIOR_SCALAR(fastAtan), -1000.0, 1000.0, 0.0, 0.0, false},
+        {"ATAN2", refAtan2, NULL, Behavior::FastMath::atan2, BEHAVIOR_SCALAR(fastAtan2), -10.0, 10.0, -10.0, 10.0, false},
+        {"POW", refPow, NULL, Behavior::FastMath::pow, BEHAVIOR_SCALAR(fastPow), 0.0, 10.0, -4.0, 4.0, true}
+    };
+    const Behavior::Precision precisions[] = {Behavior::Precision::HIGH, Behavior::Precision::LOW};
+    const char* precisionNames[] = {"HIGH", "LOW"};
+    const double bounds[] = {1e-6, 1e-3};
+
+    // Dense sweeps: x varies fastest, y is swept in sqrt(samples) steps
+    std::vector<double> x(samples), y(samples), expected(samples), actual(samples);
+    bool passed(true);
+    std::cout << std::setw(6) << "f" << std::setw(6) << "prec" << std::setw(14) << "max error"
+              << std::setw(12) << "libm ns" << std::setw(12) << "fast ns" << std::setw(10) << "speedup" << std::setw(12) << "mismatches" << "\n";
+    for (const Sweep& sweep : sweeps)
+    {
+        const std::size_t rows(sweep.binary ? static_cast<std::size_t>(std::sqrt(samples)) : 1);
+        const std::size_t cols(samples / rows);
+        for (std::size_t i = 0; i < samples; ++i)
+        {
+            const double tx((i % cols) / double(cols - 1));
+            const double ty(rows > 1 ? (i / cols) / double(rows - 1) : 0.0);
+            // The LOG sweep over many magnitudes is logarithmic
+            if (sweep.xMax / (sweep.xMin > 0.0 ? sweep.xMin : 1.0) > 1e100)
+                x[i] = sweep.xMin * std::pow(sweep.xMax / sweep.xMin, tx);
+            else
+                x[i] = sweep.xMin + (sweep.xMax - sweep.xMin) * tx;
+            y[i] = sweep.yMin + (sweep.yMax - sweep.yMin) * ty;
+        }
+
+        std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        for (std::size_t i = 0; i < samples; ++i)
+            expected[i] = sweep.reference(x[i], y[i]);
+        const double libmTime(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+
+        for (std::size_t p = 0; p < 2; ++p)
+        {
+            start = std::chrono::steady_clock::now();
+            if (sweep.unary)
+                sweep.unary(x.data(), actual.data(), samples, precisions[p]);
+            else
+                sweep.binary(x.data(), y.data(), actual.data(), samples, precisions[p]);
+            const double fastTime(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+
+            double maxError(0.0);
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                if (std::isnan(expected[i]) && std::isnan(actual[i]))
+                    continue;
+                if (std::isinf(expected[i]) && (expected[i] == actual[i]))
+                    continue;
+                double error(std::fabs(actual[i] - expected[i]));
+                if (sweep.relative && (std::fabs(expected[i]) > 1.0))
+                    error /= std::fabs(expected[i]);
+                if (!(error <= maxError))
+                    maxError = error;
+            }
+            // Batch and scalar results have to be identical (NaNs of any payload are equal)
+            std::size_t mismatches(0);
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                const double scalar(sweep.scalar[p](x[i], y[i]));
+                if ((Behavior::FastMath::bitsOf(scalar) != Behavior::FastMath::bitsOf(actual[i])) && !(std::isnan(scalar) && std::isnan(actual[i])))
+                    mismatches++;
+            }
+            const bool ok((maxError <= bounds[p]) && !mismatches);
+            passed = passed && ok;
+            std::cout << std::setw(6) << sweep.name << std::setw(6) << precisionNames[p]
+                      << std::setw(14) << std::scientific << std::setprecision(2) << maxError
+                      << std::setw(12) << std::fixed << libmTime / samples
+                      << std::setw(12) << fastTime / samples
+                      << std::setw(9) << libmTime / fastTime << "x"
+                      << std::setw(12) << mismatches
+                      << (ok ? "" : "  FAILED") << "\n";
+        }
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+#include "BehaviorGraph.hpp"
+#include "BehaviorEvaluator.hpp"
+#include "BehaviorNumeric.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"backends", required_argument, 0, 'b'},
+    {"tolerance", required_argument, 0, 't'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [options] <bg-file-in> [<subgraph-bg-file-in> ...] <trace-in>\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--backends=<list>\t" << "Comma separated backends to compare: double, float or Qm.n (default: double,float,Q15.16)\n";
+    std::cout << "--tolerance=<x>\t" << "Fail if the error of any output exceeds x\n";
+    std::cout << "\nThe SUBGRAPHs used by the model are read from the other bg files.\n";
+    std::cout << "The trace is a CSV file: the first line names INPUT nodes of the model, every further line holds their values of one step.\n";
+    std::cout << "Inputs which are not part of the trace stay zero.\n";
+    std::cout << "Every backend is compared against the Evaluator (double) and the maximum and RMS error of every output is reported.\n";
+    std::cout << "Returns 0 if all errors are within the tolerance.\n";
+    std::cout << "\nExample:\n";
+    std::cout << myName << " --backends=float,Q7.24 phaser.bg allpass.bg phaser_in.csv\n";
+}
+
+// Imports a model file. Returns false if the file could not be read or parsed
+static bool importFile(Behavior::Graph& bg, const std::string& fileName, UniqueId& modelUid)
+{
+    std::ifstream fin(fileName);
+    if (!fin.good())
+        return false;
+    modelUid = bg.importModel(fin);
+    return !modelUid.empty();
+}
+
+static std::vector<std::string> split(const std::string& line)
+{
+    std::vector<std::string> fields;
+    std::istringstream in(line);
+    std::string field;
+    while (std::getline(in, field, ','))
+    {
+        // Ignore surrounding blanks
+        const std::size_t first(field.find_first_not_of(" \t\r"));
+        const std::size_t last(field.find_last_not_of(" \t\r"));
+        fields.push_back(first == std::string::npos ? "" : field.substr(first, last - first + 1));
+    }
+    return fields;
+}
+
+// Reads a trace into one row of input values per step (ordered like the inputs of the program)
+// Returns false if the trace names unknown inputs or contains something else than numbers
+static bool readTrace(const std::string& fileName, const Behavior::Program& program, std::vector< std::vector<double> >& steps)
+{
+    std::ifstream fin(fileName);
+    std::string line;
+    if (!fin.good() || !std::getline(fin, line))
+        return false;
+    std::vector<std::size_t> columns;
+    for (const std::string& name : split(line))
+    {
+        columns.push_back(program.inputIndex(name));
+        if (columns.back() == Behavior::Program::npos)
+        {
+            std::cout << "Unknown input " << name << "\n";
+            return false;
+        }
+    }
+    while (std::getline(fin, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        const std::vector<std::string> fields(split(line));
+        if (fields.size() != columns.size())
+            return false;
+        std::vector<double> row(program.inputNames.size(), 0.0);
+        for (std::size_t c = 0; c < columns.size(); ++c)
+        {
+            char* end;
+            row[columns[c]] = std::strtod(fields[c].c_str(), &end);
+            if (fields[c].empty() || *end)
+                return false;
+        }
+        steps.push_back(row);
+    }
+    return true;
+}
+
+// The errors of every output of a backend against the reference outputs (one row per step)
+struct Report
+{
+    std::string format;
+    std::size_t bytes;
+    std::uint64_t saturations;
+    std::uint64_t parameterSaturations;
+    std::vector<double> maxError;
+    std::vector<double> rmsError;
+};
+
+template<typename Backend> static Report compare(const Behavior::Program& program, const Backend& backend,
+                                                 const std::vector< std::vector<double> >& steps,
+                                                 const std::vector< std::vector<double> >& reference)
+{
+    Behavior::NumericEvaluator<Backend> eval(program, backend);
+    const std::size_t outputs(program.outputNames.size());
+    Report report{eval.backend().format(), eval.stateBytes(), 0, eval.parameterSaturations(), std::vector<double>(outputs, 0.0), std::vector<double>(outputs, 0.0)};
+    for (std::size_t s = 0; s < steps.size(); ++s)
+    {
+        for (std::size_t i = 0; i < steps[s].size(); ++i)
+            eval.setInput(i, steps[s][i]);
+        eval.step();
+        for (std::size_t o = 0; o < outputs; ++o)
+        {
+            // NaN and infinite outputs count as infinitely wrong (unless both agree)
+            const double expected(reference[s][o]);
+            const double actual(eval.getOutput(o));
+            double error(std::fabs(actual - expected));
+            if (error != error)
+                error = ((actual == expected) || ((actual != actual) && (expected != expected))) ? 0.0 : INFINITY;
+            report.maxError[o] = std::max(report.maxError[o], error);
+            report.rmsError[o] += error * error;
+        }
+    }
+    for (std::size_t o = 0; o < outputs; ++o)
+        report.rmsError[o] = steps.empty() ? 0.0 : std::sqrt(report.rmsError[o] / steps.size());
+    report.saturations = eval.backend().saturations();
+    return report;
+}
+
+// This tool compares the outputs of a model evaluated with different numeric backends on a recorded trace
+int main (int argc, char **argv)
+{
+    std::string backends("double,float,Q15.16");
+    double tolerance(INFINITY);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hb:t:", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'b':
+                backends = optarg;
+                break;
+            case 't':
+                tolerance = std::strtod(optarg, NULL);
+                break;
+            case 'h':
+            case '?':
+                break;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    if ((argc - optind) < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Set vars
+    std::string fileNameIn(argv[optind]);
+    std::string traceIn(argv[argc-1]);
+
+    // Load files (the SUBGRAPHs first)
+    Behavior::Graph bg;
+    UniqueId modelUid;
+    for (int i = optind + 1; i < argc - 1; ++i)
+    {
+        if (!importFile(bg, argv[i], modelUid))
+        {
+            std::cout << "READ FAILED\n";
+            return 2;
+        }
+    }
+    if (!importFile(bg, fileNameIn, modelUid))
+    {
+        std::cout << "READ FAILED\n";
+        return 2;
+    }
+    Behavior::Program program(bg.compileModel(modelUid));
+    if (program.empty())
+    {
+        std::cout << "Could not compile " << fileNameIn << "\n";
+        return 4;
+    }
+    std::vector< std::vector<double> > steps;
+    if (!readTrace(traceIn, program, steps))
+    {
+        std::cout << "Could not read trace " << traceIn << "\n";
+        return 2;
+    }
+
+    // Reference outputs (evaluated node by node like the backends)
+    std::vector< std::vector<double> > reference;
+    Behavior::Evaluator eval(program, Behavior::SimdLevel::SCALAR);
+    for (const std::vector<double>& row : steps)
+    {
+        for (std::size_t i = 0; i < row.size(); ++i)
+            eval.setInput(i, row[i]);
+        eval.step();
+        reference.push_back(std::vector<double>(program.outputNames.size()));
+        for (std::size_t o = 0; o < program.outputNames.size(); ++o)
+            reference.back()[o] = eval.getOutput(o);
+    }
+
+    std::vector<Report> reports;
+    for (const std::string& backend : split(backends))
+    {
+        unsigned integerBits, fractionalBits;
+        if (backend == "double")
+        {
+            reports.push_back(compare(program, Behavior::FloatingPoint<double>(), steps, reference));
+        } else if (backend == "float") {
+            reports.push_back(compare(program, Behavior::FloatingPoint<float>(), steps, reference));
+        } else if (Behavior::FixedPoint::parse(backend, integerBits, fractionalBits)) {
+            reports.push_back(compare(program, Behavior::FixedPoint(integerBits, fractionalBits), steps, reference));
+        } else {
+            std::cout << "Unknown backend " << backend << "\n";
+            return 1;
+        }
+    }
+
+    // Print the errors of every output
+    bool withinTolerance(true);
+    std::cout << "Model " << program.name << ": " << program.nodes() << " nodes, " << steps.size() << " steps\n";
+    for (const Report& report : reports)
+    {
+        std::cout << "\nBackend " << report.format << " (" << report.bytes << " bytes of state)";
+        if (report.saturations)
+            std::cout << ", " << report.saturations << " saturations";
+        if (report.parameterSaturations)
+            std::cout << ", " << report.parameterSaturations << " saturated parameters";
+        std::cout << "\n";
+        std::cout << std::left << std::setw(24) << "output" << std::setw(16) << "max. error" << "rms error\n";
+        for (std::size_t o = 0; o < program.outputNames.size(); ++o)
+        {
+            std::cout << std::setw(24) << program.symbols.str(program.outputNames[o]) << std::scientific << std::setprecision(3)
+                      << std::setw(16) << report.maxError[o] << report.rmsError[o] << "\n";
+            if (!(report.maxError[o] <= tolerance))
+                withinTolerance = false;
+        }
+    }
+    return withinTolerance ? 0 : 1;
+}
@@ -4,39 +4,66 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 #include <cassert>
 #include <getopt.h>
+#include <sys/stat.h>
 
 static struct option long_options[] = {
     {"help", no_argument, 0, 'h'},
+    {"all", no_argument, 0, 'a'},
+    {"threads", required_argument, 0, 't'},
     {0,0,0,0}
 };
 
 void usage (const char *myName)
 {
     std::cout << "Usage:\n";
-    std::cout << myName << " <yaml-file-in> <yaml-file-out>\n\n";
+    std::cout << myName << " <yaml-file-in> <yaml-file-out>\n";
+    std::cout << myName << " --all [--threads=<n>] <yaml-file-in> <directory-out>\n\n";
     std::cout << "Options:\n";
     std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--all\t" << "Export every SUBGRAPH class with at least one part into <directory-out>/<name>.bg\n";
+    std::cout << "--threads=<n>\t" << "Number of threads exporting the models (default: all cores)\n";
     std::cout << "\nExample:\n";
     std::cout << myName << " bg-in-hypergraph.yml name-of-model-to-export.yml\n";
+    std::cout << myName << " --all bg-in-hypergraph.yml models\n";
+}
+
+static bool writeFile(const std::string& fileName, const std::string& content)
+{
+    std::ofstream fout;
+    fout.open(fileName);
+    if(!fout.good())
+        return false;
+    fout << content;
+    fout.close();
+    return true;
 }
 
 // This tool takes a language definition and tries to interpret a given domain specific format given that definition
 int main (int argc, char **argv)
 {
+    bool exportAll(false);
+    std::size_t threads(std::thread::hardware_concurrency());
 
     // Parse command line
     int c;
     while (1)
     {
         int option_index = 0;
-        c = getopt_long(argc, argv, "h", long_options, &option_index);
+        c = getopt_long(argc, argv, "hat:", long_options, &option_index);
         if (c == -1)
             break;
 
         switch (c)
         {
+            case 'a':
+                exportAll = true;
+                break;
+            case 't':
+                threads = std::stoul(optarg);
+                break;
             case 'h':
             case '?':
                 break;
@@ -60,6 +87,34 @@ int main (int argc, char **argv)
     Hypergraph hg(YAML::LoadFile(fileNameIn).as<Hypergraph>());
     Behavior::Graph bg(hg);
 
+    if (exportAll)
+    {
+        // All SUBGRAPH classes which are defined (and not only used), sorted by name
+        std::vector< std::pair<std::string, UniqueId> > models;
+        for (const UniqueId& uid : bg.algorithmClasses("", Hyperedges{Behavior::Graph::SubgraphId}))
+        {
+            if ((uid != Behavior::Graph::SubgraphId) && !bg.componentsOf(Hyperedges{uid}).empty())
+                models.push_back(std::make_pair(bg.access(uid).label(), uid));
+        }
+        std::sort(models.begin(), models.end());
+        Hyperedges modelUids;
+        for (const std::pair<std::string, UniqueId>& model : models)
+            modelUids.push_back(model.second);
+
+        const std::vector<std::string> results(bg.exportModels(modelUids, threads));
+        mkdir(fileNameOut.c_str(), 0755);
+        for (std::size_t i = 0; i < models.size(); ++i)
+        {
+            if (!writeFile(fileNameOut + "/" + models[i].first + ".bg", results[i]))
+            {
+                std::cout << "WRITE FAILED\n";
+                return 2;
+            }
+        }
+        std::cout << "Exported " << models.size() << " models\n";
+        return 0;
+    }
+
     // Call domain specific export
     std::size_t pos(fileNameOut.rfind("."));
     std::string name(fileNameOut.substr(0,pos));
@@ -72,14 +127,11 @@ int main (int argc, char **argv)
     std::string result(bg.exportModel(*candidateIds.begin()));
 
     // Store export
-    std::ofstream fout;
-    fout.open(fileNameOut);
-    if(!fout.good()) {
+    if (!writeFile(fileNameOut, result))
+    {
         std::cout << "WRITE FAILED\n";
         return 2;
     }
-    fout << result;
-    fout.close();
 
     return 0;
 }
@@ -0,0 +1,81 @@
+#include "BehaviorBinary.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " <binary-file-in> <bg-file-out>\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "\nExample:\n";
+    std::cout << myName << " phaser.bgb phaser_flat.bg\n";
+}
+
+// This tool converts a compiled program (see BehaviorBinary.hpp) back into a (flat) behavior graph model
+int main (int argc, char **argv)
+{
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "h", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'h':
+            case '?':
+                break;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    if ((argc - optind) < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Set vars
+    std::string fileNameIn(argv[optind]);
+    std::string fileNameOut(argv[optind+1]);
+
+    // Load file
+    Behavior::Program program(Behavior::loadProgram(fileNameIn));
+    if (program.empty())
+    {
+        std::cout << "READ FAILED\n";
+        return 2;
+    }
+    const std::string model(Behavior::exportNetlist(Behavior::netlistOf(program)));
+    if (model.empty())
+    {
+        std::cout << "Could not convert " << fileNameIn << "\n";
+        return 4;
+    }
+
+    // Store model
+    std::ofstream fout;
+    fout.open(fileNameOut);
+    if(!fout.good()) {
+        std::cout << "WRITE FAILED\n";
+        return 3;
+    }
+    fout << model << std::endl;
+    fout.close();
+
+    return 0;
+}
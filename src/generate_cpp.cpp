@@ -0,0 +1,131 @@
+#include "BehaviorGraph.hpp"
+#include "BehaviorOptimizer.hpp"
+#include "BehaviorCodegen.hpp"
+#include "HypergraphYAML.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"precision", required_argument, 0, 'p'},
+    {"double-buffered", no_argument, 0, 'd'},
+    {"optimize", no_argument, 0, 'o'},
+    {"namespace", required_argument, 0, 'n'},
+    {"templates", no_argument, 0, 't'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [options] <yaml-file-in> <name-of-model> <header-file-out>\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--precision=<exact|high|low>\t" << "Accuracy of the node functions (default: exact)\n";
+    std::cout << "--double-buffered\t" << "Evaluate feedback edges from a second buffer\n";
+    std::cout << "--optimize\t" << "Optimize the model first (and report what has been removed)\n";
+    std::cout << "--namespace=<name>\t" << "Namespace of the generated code (default: name of the model)\n";
+    std::cout << "--templates\t" << "Define the model as a compile-time graph (see BehaviorStatic.hpp)\n";
+    std::cout << "\nExample:\n";
+    std::cout << myName << " bg-in-hypergraph.yml phaser.bg phaser.hpp\n";
+}
+
+// This tool generates a C++ header evaluating a model without any interpretation
+int main (int argc, char **argv)
+{
+    Behavior::Precision precision(Behavior::Precision::EXACT);
+    Behavior::Feedback feedback(Behavior::Feedback::IN_PLACE);
+    bool optimize(false);
+    bool templates(false);
+    std::string ns;
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hp:don:t", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'p':
+                if (std::string(optarg) == "high")
+                    precision = Behavior::Precision::HIGH;
+                else if (std::string(optarg) == "low")
+                    precision = Behavior::Precision::LOW;
+                break;
+            case 'd':
+                feedback = Behavior::Feedback::DOUBLE_BUFFERED;
+                break;
+            case 'o':
+                optimize = true;
+                break;
+            case 'n':
+                ns = optarg;
+                break;
+            case 't':
+                templates = true;
+                break;
+            case 'h':
+            case '?':
+                break;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    if ((argc - optind) < 3)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Set vars
+    std::string fileNameIn(argv[optind]);
+    std::string name(argv[optind+1]);
+    std::string fileNameOut(argv[optind+2]);
+
+    // Load file
+    Hypergraph hg(YAML::LoadFile(fileNameIn).as<Hypergraph>());
+    Behavior::Graph bg(hg);
+
+    Hyperedges candidateIds(bg.algorithmClasses(name, Hyperedges{Behavior::Graph::SubgraphId}));
+    if (!candidateIds.size())
+    {
+        std::cout << "Could not find " << name << "\n";
+        return 3;
+    }
+    Behavior::Netlist netlist(bg.flattenModel(*candidateIds.begin()));
+    if (netlist.empty())
+    {
+        std::cout << "Could not lower " << name << "\n";
+        return 4;
+    }
+    if (optimize)
+        std::cout << Behavior::optimize(netlist, precision);
+    const Behavior::Program program(netlist, precision, feedback);
+    std::string result(templates ? Behavior::generateStaticCpp(program, ns) : Behavior::generateCpp(program, ns));
+    if (result.empty())
+    {
+        std::cout << "Could not generate code for " << name << "\n";
+        return 4;
+    }
+
+    // Store header
+    std::ofstream fout;
+    fout.open(fileNameOut);
+    if(!fout.good()) {
+        std::cout << "WRITE FAILED\n";
+        return 2;
+    }
+    fout << result;
+    fout.close();
+
+    return 0;
+}
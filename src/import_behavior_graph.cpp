@@ -4,38 +4,73 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 #include <cassert>
 #include <getopt.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
 static struct option long_options[] = {
     {"help", no_argument, 0, 'h'},
+    {"threads", required_argument, 0, 't'},
     {0,0,0,0}
 };
 
 void usage (const char *myName)
 {
     std::cout << "Usage:\n";
-    std::cout << myName << " <yaml-file-in> <yaml-file-out>\n\n";
+    std::cout << myName << " [--threads=<n>] <yaml-file-in> [<yaml-file-in>...] <yaml-file-out>\n\n";
     std::cout << "Options:\n";
     std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--threads=<n>\t" << "Number of threads parsing the input files (default: all cores)\n";
+    std::cout << "\nAn input can also be a directory, then all its .bg files are imported.\n";
+    std::cout << "All inputs are imported into one hypergraph, every SUBGRAPH before the models using it.\n";
     std::cout << "\nExample:\n";
     std::cout << myName << " bg.yml imported_bg.yml\n";
+    std::cout << myName << " models/ imported_models.yml\n";
+}
+
+// Appends the file or the .bg files of a directory (sorted by name)
+static void addInput(const std::string& path, std::vector<std::string>& fileNames)
+{
+    struct stat info;
+    if ((stat(path.c_str(), &info) != 0) || !S_ISDIR(info.st_mode))
+    {
+        fileNames.push_back(path);
+        return;
+    }
+    std::vector<std::string> entries;
+    DIR* dir(opendir(path.c_str()));
+    while (struct dirent* entry = (dir ? readdir(dir) : NULL))
+    {
+        const std::string name(entry->d_name);
+        if ((name.size() > 3) && (name.compare(name.size() - 3, 3, ".bg") == 0))
+            entries.push_back(path + "/" + name);
+    }
+    if (dir)
+        closedir(dir);
+    std::sort(entries.begin(), entries.end());
+    fileNames.insert(fileNames.end(), entries.begin(), entries.end());
 }
 
 int main (int argc, char **argv)
 {
+    std::size_t threads(std::thread::hardware_concurrency());
 
     // Parse command line
     int c;
     while (1)
     {
         int option_index = 0;
-        c = getopt_long(argc, argv, "h", long_options, &option_index);
+        c = getopt_long(argc, argv, "ht:", long_options, &option_index);
         if (c == -1)
             break;
 
         switch (c)
         {
+            case 't':
+                threads = std::stoul(optarg);
+                break;
             case 'h':
             case '?':
                 break;
@@ -52,24 +87,46 @@ int main (int argc, char **argv)
     }
 
     // Set vars
-    std::string fileNameIn(argv[optind]);
-    std::string fileNameOut(argv[optind+1]);
-
-    // Load file
-    std::ifstream fin;
-    fin.open(fileNameIn);
-    if(!fin.good()) {
-        std::cout << "READ FAILED\n";
-        return 2;
-    }
-    std::stringstream ss;
-    ss << fin.rdbuf();
+    std::vector<std::string> fileNamesIn;
+    for (int i = optind; i < argc - 1; ++i)
+        addInput(argv[i], fileNamesIn);
+    std::string fileNameOut(argv[argc-1]);
 
-    // Create domain specific model
     Behavior::Graph bg;
-    bg.importModel(ss.str());
+    if ((fileNamesIn.size() == 1) && (argc - optind == 2))
+    {
+        // Load file
+        std::ifstream fin;
+        fin.open(fileNamesIn[0]);
+        if(!fin.good()) {
+            std::cout << "READ FAILED\n";
+            return 2;
+        }
+
+        // Create domain specific model (nothing is created if the file is malformed)
+        const UniqueId modelUid(bg.importModel(fin));
+        fin.close();
+        if (modelUid.empty())
+        {
+            std::cout << "Could not import " << fileNamesIn[0] << "\n";
+            return 2;
+        }
+    } else {
+        // Create all models of the batch
+        const Hyperedges modelUids(bg.importModels(fileNamesIn, threads));
+        std::size_t failed(0);
+        for (std::size_t i = 0; i < fileNamesIn.size(); ++i)
+        {
+            if (!modelUids[i].empty())
+                continue;
+            std::cout << "Could not import " << fileNamesIn[i] << "\n";
+            failed++;
+        }
+        std::cout << "Imported " << fileNamesIn.size() - failed << " of " << fileNamesIn.size() << " models\n";
+    }
 
-    // Store modified graph
+    // Store modified graph (the numbers of the model become labels only now)
+    bg.storeRealValues();
     std::ofstream fout;
     fout.open(fileNameOut);
     if(!fout.good()) {
@@ -78,7 +135,6 @@ int main (int argc, char **argv)
     }
     fout << YAML::StringFrom(bg) << std::endl;
     fout.close();
-    fin.close();
 
     return 0;
 }
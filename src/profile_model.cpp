@@ -0,0 +1,144 @@
+#include "BehaviorGraph.hpp"
+#include "BehaviorProfiler.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"steps", required_argument, 0, 's'},
+    {"folded", no_argument, 0, 'f'},
+    {"precision", required_argument, 0, 'p'},
+    {"double-buffered", no_argument, 0, 'd'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [options] <bg-file-in> [<subgraph-bg-file-in> ...] <profile-out>\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--steps=<n>\t" << "Number of steps to evaluate (default: 10000)\n";
+    std::cout << "--folded\t" << "Write folded stacks (for flame graphs) instead of YAML\n";
+    std::cout << "--precision=<exact|high|low>\t" << "Accuracy of the node functions (default: exact)\n";
+    std::cout << "--double-buffered\t" << "Evaluate feedback edges from a second buffer\n";
+    std::cout << "\nThe SUBGRAPHs used by the model are read from the other bg files.\n";
+    std::cout << "The inputs of the model are driven by sine waves of different frequencies.\n";
+    std::cout << "\nExample:\n";
+    std::cout << myName << " phaser.bg allpass.bg phaser.profile.yml\n";
+    std::cout << myName << " --folded phaser.bg allpass.bg phaser.folded && flamegraph.pl phaser.folded > phaser.svg\n";
+}
+
+// Imports a model file. Returns false if the file could not be read or parsed
+static bool importFile(Behavior::Graph& bg, const std::string& fileName, UniqueId& modelUid)
+{
+    std::ifstream fin(fileName);
+    if (!fin.good())
+        return false;
+    modelUid = bg.importModel(fin);
+    return !modelUid.empty();
+}
+
+// This tool measures which nodes and SUBGRAPH instances of a model take the most time
+int main (int argc, char **argv)
+{
+    std::size_t steps(10000);
+    bool folded(false);
+    Behavior::Precision precision(Behavior::Precision::EXACT);
+    Behavior::Feedback feedback(Behavior::Feedback::IN_PLACE);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hs:fp:d", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 's':
+                steps = std::stoul(optarg);
+                break;
+            case 'f':
+                folded = true;
+                break;
+            case 'p':
+                if (std::string(optarg) == "high")
+                    precision = Behavior::Precision::HIGH;
+                else if (std::string(optarg) == "low")
+                    precision = Behavior::Precision::LOW;
+                break;
+            case 'd':
+                feedback = Behavior::Feedback::DOUBLE_BUFFERED;
+                break;
+            case 'h':
+            case '?':
+                break;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    if ((argc - optind) < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Set vars
+    std::string fileNameIn(argv[optind]);
+    std::string fileNameOut(argv[argc-1]);
+
+    // Load files (the SUBGRAPHs first)
+    Behavior::Graph bg;
+    UniqueId modelUid;
+    for (int i = optind + 1; i < argc - 1; ++i)
+    {
+        if (!importFile(bg, argv[i], modelUid))
+        {
+            std::cout << "READ FAILED\n";
+            return 2;
+        }
+    }
+    if (!importFile(bg, fileNameIn, modelUid))
+    {
+        std::cout << "READ FAILED\n";
+        return 2;
+    }
+    Behavior::Program program(bg.compileModel(modelUid, precision, feedback));
+    if (program.empty())
+    {
+        std::cout << "Could not compile " << fileNameIn << "\n";
+        return 4;
+    }
+
+    // Run the model
+    Behavior::ProfilingEvaluator eval(program);
+    for (std::size_t s = 0; s < steps; ++s)
+    {
+        for (std::size_t i = 0; i < program.inputNames.size(); ++i)
+            eval.setInput(i, std::sin(0.01 * (i + 1) * s));
+        eval.step();
+    }
+
+    // Store profile
+    std::ofstream fout;
+    fout.open(fileNameOut);
+    if(!fout.good()) {
+        std::cout << "WRITE FAILED\n";
+        return 3;
+    }
+    if (folded)
+        fout << Behavior::profileToFoldedStacks(eval);
+    else
+        fout << Behavior::profileToYAML(eval) << std::endl;
+    fout.close();
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "BehaviorGraph.hpp"
+#include "BehaviorOptimizer.hpp"
+#include "BehaviorBinary.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <getopt.h>
+
+static struct option long_options[] = {
+    {"help", no_argument, 0, 'h'},
+    {"precision", required_argument, 0, 'p'},
+    {"double-buffered", no_argument, 0, 'd'},
+    {"optimize", no_argument, 0, 'o'},
+    {0,0,0,0}
+};
+
+void usage (const char *myName)
+{
+    std::cout << "Usage:\n";
+    std::cout << myName << " [options] <bg-file-in> [<subgraph-bg-file-in> ...] <binary-file-out>\n\n";
+    std::cout << "Options:\n";
+    std::cout << "--help\t" << "Show usage\n";
+    std::cout << "--precision=<exact|high|low>\t" << "Accuracy of the node functions (default: exact)\n";
+    std::cout << "--double-buffered\t" << "Evaluate feedback edges from a second buffer\n";
+    std::cout << "--optimize\t" << "Optimize the model first (and report what has been removed)\n";
+    std::cout << "\nThe SUBGRAPHs used by the model are read from the other bg files.\n";
+    std::cout << "\nExample:\n";
+    std::cout << myName << " phaser.bg allpass.bg phaser.bgb\n";
+}
+
+// Imports a model file. Returns false if the file could not be read or parsed
+static bool importFile(Behavior::Graph& bg, const std::string& fileName, UniqueId& modelUid)
+{
+    std::ifstream fin(fileName);
+    if (!fin.good())
+        return false;
+    modelUid = bg.importModel(fin);
+    return !modelUid.empty();
+}
+
+// This tool compiles a behavior graph model into the binary format (see BehaviorBinary.hpp)
+int main (int argc, char **argv)
+{
+    Behavior::Precision precision(Behavior::Precision::EXACT);
+    Behavior::Feedback feedback(Behavior::Feedback::IN_PLACE);
+    bool optimize(false);
+
+    // Parse command line
+    int c;
+    while (1)
+    {
+        int option_index = 0;
+        c = getopt_long(argc, argv, "hp:do", long_options, &option_index);
+        if (c == -1)
+            break;
+
+        switch (c)
+        {
+            case 'p':
+                if (std::string(optarg) == "high")
+                    precision = Behavior::Precision::HIGH;
+                else if (std::string(optarg) == "low")
+                    precision = Behavior::Precision::LOW;
+                break;
+            case 'd':
+                feedback = Behavior::Feedback::DOUBLE_BUFFERED;
+                break;
+            case 'o':
+                optimize = true;
+                break;
+            case 'h':
+            case '?':
+                break;
+            default:
+                std::cout << "W00t?!\n";
+                return 1;
+        }
+    }
+
+    if ((argc - optind) < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Set vars
+    std::string fileNameIn(argv[optind]);
+    std::string fileNameOut(argv[argc-1]);
+
+    // Load files (the SUBGRAPHs first)
+    Behavior::Graph bg;
+    UniqueId modelUid;
+    for (int i = optind + 1; i < argc - 1; ++i)
+    {
+        if (!importFile(bg, argv[i], modelUid))
+        {
+            std::cout << "READ FAILED\n";
+            return 2;
+        }
+    }
+    if (!importFile(bg, fileNameIn, modelUid))
+    {
+        std::cout << "READ FAILED\n";
+        return 2;
+    }
+    Behavior::Netlist netlist(bg.flattenModel(modelUid));
+    if (netlist.empty())
+    {
+        std::cout << "Could not compile " << fileNameIn << "\n";
+        return 4;
+    }
+    if (optimize)
+        std::cout << Behavior::optimize(netlist, precision);
+
+    // Store program
+    if (!Behavior::saveProgram(Behavior::Program(netlist, precision, feedback), fileNameOut))
+    {
+        std::cout << "WRITE FAILED\n";
+        return 3;
+    }
+
+    return 0;
+}